@@ -0,0 +1,105 @@
+/**
+ * Reads pages of 50 entries from a 100,000-entry array: by calling next()
+ * from the first entry, as arrayobject allowed before at(), and with at()
+ * with and without an arrayindex. Then counts the entries of that array,
+ * and of an array of numbers, with count() and by calling next() until the
+ * end.
+ */
+#include "json.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+template<typename F>
+static void measure(const std::vector<std::size_t>& pages, F&& page)
+{
+    std::int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto p : pages)
+        sum += page(p * 50);
+    auto elapsed = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%10.1f us/page  (checksum %lld)\n", elapsed / pages.size(),
+                static_cast<long long>(sum));
+}
+
+// Reads fifty entries beginning with the given one
+static std::int64_t readPage(minjson::arrayobject entry)
+{
+    std::int64_t sum = 0;
+    for (int i = 0; i < 50 && entry.valid(); i++, entry.next())
+        sum += *entry.getObject()->find("id")->get<std::int64_t>();
+    return sum;
+}
+
+int main()
+{
+    std::string json = R"({"items": [)";
+    for (int i = 0; i < 100000; i++) {
+        json += i > 0 ? ", " : "";
+        json += R"({"id": )" + std::to_string(i) + R"(, "title": "Item )" +
+                std::to_string(i) + R"(", "tags": ["a", "b"]})";
+    }
+    json += R"(], "ids": [)";
+    for (int i = 0; i < 100000; i++)
+        json += (i > 0 ? ", " : "") + std::to_string(i * 7);
+    json += "]}";
+
+    std::mt19937 rng (42);
+    std::vector<std::size_t> pages;
+    for (int i = 0; i < 200; i++)
+        pages.push_back(rng() % 2000);
+
+    minjson::parser p;
+    p.start(json);
+    const auto items = *p.find("items")->getArrayFirst();
+
+    std::printf("next() from first:  ");
+    measure(pages, [&](std::size_t first) {
+        auto entry = items;
+        for (std::size_t i = 0; i < first && entry.valid(); i++)
+            entry.next();
+        return readPage(entry);
+    });
+
+    std::printf("at():               ");
+    measure(pages, [&](std::size_t first) {
+        return readPage(items.at(first));
+    });
+
+    std::vector<std::uint32_t> storage (100000 / 50 + 1);
+    minjson::arrayindex index (storage, 50);
+    std::printf("at() with index:    ");
+    measure(pages, [&](std::size_t first) {
+        return readPage(items.at(first, index));
+    });
+
+    auto time = [](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        auto n = fn();
+        auto elapsed = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+        std::printf("%10.1f us  (%zu entries)\n", elapsed, n);
+    };
+
+    const auto ids = *p.find("ids")->getArrayFirst();
+    for (const auto& array : {items, ids}) {
+        std::printf("count():            ");
+        time([&] { return array.count(); });
+
+        std::printf("next() to the end:  ");
+        time([&] {
+            std::size_t n = 0;
+            for (auto entry = array; entry.valid(); entry.next())
+                n++;
+            return n;
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+/**
+ * Reads three fields from a 2 KB RPC message with cursor::find(), against
+ * parser::find(), which searches from the first member each time and
+ * determines the type of every member it passes.
+ */
+#include "json.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+template<typename F>
+static void measure(const std::string& json, F&& read)
+{
+    constexpr int passes = 200000;
+    std::int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++)
+        sum += read(json);
+    auto elapsed = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%10.1f ns/message  (checksum %lld)\n", elapsed / passes,
+                static_cast<long long>(sum));
+}
+
+int main()
+{
+    // A request whose parameters the handler mostly ignores, placed before
+    // the fields it reads
+    std::string json = R"({"params": {"records": [)";
+    for (int i = 0; json.size() < 1900; i++) {
+        json += i > 0 ? ", " : "";
+        json += R"({"key": "record)" + std::to_string(i) + R"(", "values": [1.5, 2.25, -3], "note": "a, b"})";
+    }
+    json += R"(], "flags": {"dryRun": false}}, "jsonrpc": "2.0", "id": 42, "method": "update", )";
+    json += R"("deadline": 1700000000})";
+    std::printf("%zu-byte message\n", json.size());
+
+    auto fields = [](auto&& find) {
+        std::int64_t sum = *find("id")->template get<std::int64_t>();
+        sum += find("method")->raw().size();
+        sum += *find("deadline")->template get<std::int64_t>();
+        return sum;
+    };
+
+    std::printf("parser::find():     ");
+    measure(json, [&](const std::string& j) {
+        minjson::parser p;
+        p.start(j);
+        return fields([&](std::string_view key) { return p.find(key); });
+    });
+
+    std::printf("cursor::find():     ");
+    measure(json, [&](const std::string& j) {
+        minjson::parser p;
+        p.start(j);
+        minjson::cursor c (p);
+        return fields([&](std::string_view key) { return c.find(key); });
+    });
+
+    std::printf("  with document:    ");
+    measure(json, [&](const std::string& j) {
+        std::uint64_t storage[64];
+        std::uint32_t table[256];
+        minjson::document doc;
+        doc.build(j, storage, table);
+        minjson::parser p;
+        p.start(doc);
+        minjson::cursor c (p);
+        return fields([&](std::string_view key) { return c.find(key); });
+    });
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+/**
+ * Compares the first-character dispatch of parser::determineType(), driven
+ * by the charclass table, against the chain of comparisons it replaced, on
+ * an array of mixed-type values. Branch misses are counted where the
+ * kernel allows (Linux perf events).
+ */
+#include "json.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Counts branch misses of the calling thread, if possible.
+ */
+class branchmisses
+{
+private:
+    int m_fd = -1;
+
+public:
+    branchmisses() {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~branchmisses() {
+#if defined(__linux__)
+        if (m_fd >= 0)
+            close(m_fd);
+#endif
+    }
+
+    void start() {
+#if defined(__linux__)
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    long long stop() {
+        long long count = -1;
+#if defined(__linux__)
+        if (m_fd >= 0) {
+            ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(m_fd, &count, sizeof(count)) != sizeof(count))
+                count = -1;
+        }
+#endif
+        return count;
+    }
+};
+
+template<typename F>
+static void measure(const char *name, std::size_t count, F&& run)
+{
+    branchmisses misses;
+    misses.start();
+    auto start = std::chrono::steady_clock::now();
+    auto checksum = run();
+    auto elapsed = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+    auto missed = misses.stop();
+
+    std::printf("%-24s %8.2f ns/value", name, elapsed / count);
+    if (missed >= 0)
+        std::printf("  %6.3f misses/value", static_cast<double>(missed) / count);
+    else
+        std::printf("  (branch misses n/a)");
+    std::printf("  (checksum %zu)\n", checksum);
+}
+
+/**
+ * The dispatch used before the charclass table.
+ */
+static minjson::type chainDispatch(std::string_view val)
+{
+    auto i = val.find_first_not_of(" \t\r\n");
+    char c = val[i];
+    if (c == '\"')
+        return minjson::type::string;
+    else if ((c >= '0' && c <= '9') || c == '-')
+        return minjson::type::number;
+    else if (c == '{')
+        return minjson::type::object;
+    else if (c == '[')
+        return minjson::type::array;
+    else if (c == 'n')
+        return minjson::type::null;
+    else
+        return minjson::type::boolean;
+}
+
+/**
+ * The dispatch used by determineType().
+ */
+static minjson::type tableDispatch(std::string_view val)
+{
+    auto i = minjson::firstNonSpace(val);
+    switch (minjson::classOf(val[i])) {
+    case minjson::charclass::quote:
+        return minjson::type::string;
+    case minjson::charclass::object:
+        return minjson::type::object;
+    case minjson::charclass::array:
+        return minjson::type::array;
+    case minjson::charclass::literal:
+        return val[i] == 'n' ? minjson::type::null : minjson::type::boolean;
+    default:
+        return minjson::type::number;
+    }
+}
+
+int main()
+{
+    constexpr int passes = 20;
+    const char *samples[] = {
+        "12", "-3.5", "\"text\"", "{ \"a\": 1 }", "[1, 2]", "true", "false", "null"
+    };
+
+    // A shuffled array of mixed values, with varying whitespace
+    std::mt19937 rng (42);
+    std::string json = "{ \"values\": [";
+    std::vector<std::string_view> values;
+    std::vector<std::size_t> offsets;
+    for (int i = 0; i < 200000; i++) {
+        if (i > 0)
+            json += ',';
+        offsets.push_back(json.size());
+        json += std::string(rng() % 3, ' ');
+        json += samples[rng() % std::size(samples)];
+    }
+    offsets.push_back(json.size() + 1);
+    json += "] }";
+    for (std::size_t i = 0; i + 1 < offsets.size(); i++)
+        values.push_back(std::string_view(json).substr(offsets[i], offsets[i + 1] - offsets[i] - 1));
+
+    const auto count = values.size() * passes;
+    measure("comparison chain:", count, [&] {
+        std::size_t sum = 0;
+        for (int p = 0; p < passes; p++) {
+            for (auto v : values)
+                sum += static_cast<std::size_t>(chainDispatch(v));
+        }
+        return sum;
+    });
+    measure("charclass table:", count, [&] {
+        std::size_t sum = 0;
+        for (int p = 0; p < passes; p++) {
+            for (auto v : values)
+                sum += static_cast<std::size_t>(tableDispatch(v));
+        }
+        return sum;
+    });
+    measure("arrayobject iteration:", count, [&] {
+        minjson::parser p;
+        p.start(json);
+        auto array = *p.next()->getArrayFirst();
+        std::size_t sum = 0;
+        for (int pass = 0; pass < passes; pass++) {
+            for (array.rewind(); array.valid(); array.next())
+                sum += static_cast<std::size_t>(array.type());
+        }
+        return sum;
+    });
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * Compares escape() against escaping one byte at a time, on log messages
+ * with an occasional quote, newline or tab.
+ */
+#include "json.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::size_t escapeBytes(std::string_view str, char *out)
+{
+    constexpr char hex[] = "0123456789abcdef";
+    std::size_t size = 0;
+    for (auto c : str) {
+        const auto u = static_cast<unsigned char>(c);
+        if (c == '\"' || c == '\\') {
+            out[size++] = '\\';
+            out[size++] = c;
+        } else if (u >= 0x20) {
+            out[size++] = c;
+        } else if (c == '\n') {
+            out[size++] = '\\';
+            out[size++] = 'n';
+        } else if (c == '\t') {
+            out[size++] = '\\';
+            out[size++] = 't';
+        } else {
+            for (auto e : {'\\', 'u', '0', '0', hex[u >> 4], hex[u & 15]})
+                out[size++] = e;
+        }
+    }
+    return size;
+}
+
+template<typename F>
+static void measure(const std::vector<std::string>& corpus, F&& escape)
+{
+    static char buffer[4096];
+    std::size_t bytes = 0, sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < 20; pass++) {
+        for (const auto& s : corpus) {
+            sum += escape(s, buffer) + buffer[0];
+            bytes += s.size();
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%10.2f MB/s  (checksum %zu)\n", bytes / elapsed / 1e6, sum);
+}
+
+int main()
+{
+    std::mt19937 rng (42);
+    const std::string_view words[] = {
+        "request", "completed", "in", "ms", "user", "id=", "status", "GET",
+        "/api/v1/items", "error:", "timeout", "connecting", "to", "upstream",
+        "retrying", "cache", "miss", "for", "key", "value", "path", "from",
+    };
+
+    std::vector<std::string> messages;
+    for (int i = 0; i < 50000; i++) {
+        std::string m;
+        const auto count = 8 + rng() % 40;
+        for (unsigned w = 0; w < count; w++) {
+            m += words[rng() % std::size(words)];
+            const auto r = rng() % 100;
+            m += r == 0 ? '\n' : r == 1 ? '\t' : r == 2 ? '\"' : ' ';
+        }
+        messages.push_back(m);
+    }
+
+    std::printf("escape():          ");
+    measure(messages, [](std::string_view s, char *out) {
+        return *minjson::escape(s, std::span(out, 4096));
+    });
+
+    std::printf("byte at a time:    ");
+    measure(messages, escapeBytes);
+
+    return 0;
+}
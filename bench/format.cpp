@@ -0,0 +1,80 @@
+/**
+ * Compares format::shortest() and format::integer() against std::to_chars
+ * and snprintf on a corpus of numbers like those written to JSON.
+ */
+#include "json.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+template<typename T, typename F>
+static void measure(const std::vector<T>& corpus, F&& write)
+{
+    char buffer[64];
+    std::size_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < 10; pass++) {
+        for (auto n : corpus)
+            sum += write(buffer, n) + buffer[0];
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%12.2f ns/number  (checksum %zu)\n", elapsed / (10.0 * corpus.size()), sum);
+}
+
+int main()
+{
+    std::mt19937_64 rng (42);
+    std::uniform_real_distribution<double> coordinate (-180, 180);
+    std::uniform_real_distribution<double> unit (0, 1);
+
+    // Coordinates, prices, whole numbers and full-precision doubles
+    std::vector<double> doubles;
+    std::vector<std::int64_t> integers;
+    char text[64];
+    for (int i = 0; i < 250000; i++) {
+        std::snprintf(text, sizeof(text), "%.6f", coordinate(rng));
+        doubles.push_back(std::strtod(text, nullptr));
+        std::snprintf(text, sizeof(text), "%.2f", unit(rng) * 1000);
+        doubles.push_back(std::strtod(text, nullptr));
+        doubles.push_back(static_cast<double>(rng() % 1000000));
+        doubles.push_back(unit(rng) * 1e-3);
+
+        integers.push_back(static_cast<std::int64_t>(rng() % 1000));
+        integers.push_back(static_cast<std::int64_t>(rng() % 10000000) - 5000000);
+        integers.push_back(static_cast<std::int64_t>(rng() >> (rng() % 64)));
+        integers.push_back(static_cast<std::int64_t>(rng()));
+    }
+
+    std::printf("format::shortest:   ");
+    measure(doubles, [](char *out, double d) {
+        return minjson::format::shortest(out, d);
+    });
+
+    std::printf("std::to_chars:      ");
+    measure(doubles, [](char *out, double d) {
+        return static_cast<std::size_t>(std::to_chars(out, out + 64, d).ptr - out);
+    });
+
+    std::printf("snprintf %%.17g:     ");
+    measure(doubles, [](char *out, double d) {
+        return static_cast<std::size_t>(std::snprintf(out, 64, "%.17g", d));
+    });
+
+    std::printf("format::integer:    ");
+    measure(integers, [](char *out, std::int64_t n) {
+        return minjson::format::integer(out, n);
+    });
+
+    std::printf("std::to_chars:      ");
+    measure(integers, [](char *out, std::int64_t n) {
+        return static_cast<std::size_t>(std::to_chars(out, out + 64, n).ptr - out);
+    });
+
+    return 0;
+}
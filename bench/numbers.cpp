@@ -0,0 +1,62 @@
+/**
+ * Compares objectbase::get<double>() against std::from_chars on a corpus of
+ * numbers like those found in numeric-heavy JSON.
+ */
+#include "json.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+template<typename F>
+static double measure(const std::vector<std::string>& corpus, F&& convert)
+{
+    double sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < 10; pass++) {
+        for (const auto& s : corpus)
+            sum += convert(s);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%12.2f ns/number  (checksum %g)\n", elapsed / (10.0 * corpus.size()), sum);
+    return elapsed;
+}
+
+int main()
+{
+    std::mt19937_64 rng (42);
+    std::uniform_real_distribution<double> coordinate (-180, 180);
+    std::uniform_real_distribution<double> unit (0, 1);
+
+    // Coordinates, prices, integers and full-precision doubles
+    std::vector<std::string> corpus;
+    char buffer[64];
+    for (int i = 0; i < 250000; i++) {
+        std::snprintf(buffer, sizeof(buffer), "%.6f", coordinate(rng));
+        corpus.emplace_back(buffer);
+        std::snprintf(buffer, sizeof(buffer), "%.2f", unit(rng) * 1000);
+        corpus.emplace_back(buffer);
+        corpus.emplace_back(std::to_string(rng() % 1000000));
+        std::snprintf(buffer, sizeof(buffer), "%.17g", unit(rng) * 1e-3);
+        corpus.emplace_back(buffer);
+    }
+
+    std::printf("minjson get<double>:");
+    measure(corpus, [](const std::string& s) {
+        return *minjson::objectbase(minjson::type::number, s).get<double>();
+    });
+
+    std::printf("std::from_chars:    ");
+    measure(corpus, [](const std::string& s) {
+        double d = 0;
+        std::from_chars(s.data(), s.data() + s.size(), d);
+        return d;
+    });
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * Compares visit() against walking a document the way main.cpp does, with
+ * a parser per object and getArrayFirst() per array. Both sum every number
+ * and count the bytes of every string.
+ */
+#include "json.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+struct totals
+{
+    double sum = 0;
+    std::size_t bytes = 0;
+
+    void on_number(const minjson::objectbase& n) { sum += *n.get<double>(); }
+    void on_string(std::string_view str) { bytes += str.size(); }
+};
+
+static void walkObject(minjson::parser p, totals& t);
+
+static void walkValue(const minjson::objectbase& o, totals& t)
+{
+    switch (o.type()) {
+    case minjson::type::number:
+        t.sum += *o.get<double>();
+        break;
+    case minjson::type::string:
+        t.bytes += o.get<std::string_view>()->size();
+        break;
+    case minjson::type::object:
+        walkObject(*o.getObject(), t);
+        break;
+    case minjson::type::array:
+        for (auto iter = *o.getArrayFirst(); iter.valid(); iter.next())
+            walkValue(iter, t);
+        break;
+    default:
+        break;
+    }
+}
+
+static void walkObject(minjson::parser p, totals& t)
+{
+    while (auto o = p.next())
+        walkValue(*o, t);
+}
+
+template<typename F>
+static void measure(const std::string& json, F&& walk)
+{
+    totals t;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < 20; pass++)
+        walk(json, t);
+    auto elapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%10.2f MB/s  (sum %.0f, bytes %zu)\n",
+                20 * json.size() / elapsed / 1e6, t.sum, t.bytes);
+}
+
+int main()
+{
+    // Records of a few levels, as from an API listing
+    std::mt19937 rng (42);
+    std::string json = "{\"items\": [";
+    for (int i = 0; i < 20000; i++) {
+        json += i > 0 ? ", " : "";
+        json += "{\"id\": " + std::to_string(i) +
+                ", \"name\": \"item" + std::to_string(rng() % 1000) +
+                "\", \"price\": " + std::to_string(rng() % 10000) + "." + std::to_string(rng() % 100) +
+                ", \"tags\": [\"a\", \"bc\", \"def\"], \"stock\": {\"count\": " +
+                std::to_string(rng() % 500) + ", \"ready\": true}}";
+    }
+    json += "]}";
+
+    std::printf("visit():            ");
+    measure(json, [](const std::string& j, totals& t) { minjson::visit(j, t); });
+
+    std::printf("parser recursion:   ");
+    measure(json, [](const std::string& j, totals& t) {
+        minjson::parser p;
+        p.start(j);
+        walkObject(p, t);
+    });
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "json.hpp"
+#include "mappedfile.hpp"
 
 #include <iostream>
 
@@ -95,10 +96,19 @@ void iterateParser(json::parser test)
     }
 }
 
-int main(void)
+int main(int argc, char **argv)
 {
     json::parser test;
-    test.start(testJson);
+    json::mappedfile file;
+    if (argc > 1) {
+        if (!file.open(argv[1])) {
+            std::cerr << "Failed to open " << argv[1] << std::endl;
+            return 1;
+        }
+        test.start(file.view());
+    } else {
+        test.start(testJson);
+    }
     iterateParser(test);
     return 0;
 }
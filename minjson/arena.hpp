@@ -0,0 +1,87 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_ARENA_HPP_
+#define MINJSON_ARENA_HPP_
+
+#include <cstddef>
+#include <optional>
+#include <span>
+
+namespace minjson
+{
+    /**
+     * Hands out pieces of a caller-provided buffer, front to back. Nothing
+     * is freed individually; reset() makes the whole buffer available again.
+     */
+    class arena
+    {
+    private:
+        std::span<char> m_storage;
+        std::size_t m_used;
+
+    public:
+        constexpr arena(std::span<char> storage) : m_storage(storage), m_used(0) {}
+
+        /**
+         * Returns the number of bytes handed out.
+         */
+        constexpr std::size_t used() const {
+            return m_used;
+        }
+
+        /**
+         * Returns the number of bytes still available.
+         */
+        constexpr std::size_t remaining() const {
+            return m_storage.size() - m_used;
+        }
+
+        /**
+         * Makes the entire buffer available again.
+         */
+        constexpr void reset() {
+            m_used = 0;
+        }
+
+        /**
+         * Takes the given number of bytes from the buffer.
+         * @return The bytes, or nothing if not enough remain
+         */
+        constexpr std::optional<std::span<char>> allocate(std::size_t size) {
+            if (size > remaining())
+                return {};
+
+            auto piece = m_storage.subspan(m_used, size);
+            m_used += size;
+            return piece;
+        }
+
+        /**
+         * Gives back the end of the last allocation, keeping only its first
+         * size bytes. Has no effect on any other allocation.
+         */
+        constexpr void shrink(std::span<char> last, std::size_t size) {
+            if (size < last.size() && !last.empty() &&
+                last.data() + last.size() == m_storage.data() + m_used)
+            {
+                m_used -= last.size() - size;
+            }
+        }
+    };
+}
+
+#endif // MINJSON_ARENA_HPP_
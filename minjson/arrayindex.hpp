@@ -0,0 +1,120 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_ARRAYINDEX_HPP_
+#define MINJSON_ARRAYINDEX_HPP_
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * Offsets of the entries of one JSON array, recorded as they are first
+     * reached. Used by arrayobject::at() so that reaching an entry does not
+     * pass over every entry before it again.
+     *
+     * Only every stride-th offset is kept, so that large arrays can be
+     * indexed in little memory; at() then passes over fewer than stride
+     * entries. Storage is provided by the caller. Once it is full, entries
+     * further on are reached from the last recorded offset.
+     */
+    class arrayindex
+    {
+    private:
+        constexpr static auto npos = std::string_view::npos;
+
+        std::span<std::uint32_t> m_offsets;
+        std::string_view m_array; // The array data that has been indexed
+        std::size_t m_stride;
+        std::size_t m_count; // Offsets recorded
+        std::size_t m_size;  // Number of entries, or npos until known
+
+    public:
+        /**
+         * @param storage Storage for offsets; an array of n entries needs
+         *                n / stride + 1 to be fully indexed
+         * @param stride Distance between the entries whose offsets are kept
+         */
+        constexpr arrayindex(std::span<std::uint32_t> storage, std::size_t stride = 1) :
+            m_offsets(storage), m_stride(stride > 0 ? stride : 1), m_count(0),
+            m_size(npos) {}
+
+        /**
+         * Tells if the index holds offsets for the given array data.
+         */
+        constexpr bool holds(std::string_view array) const {
+            return m_array.data() == array.data() && m_array.size() == array.size();
+        }
+
+        /**
+         * Empties the index, preparing it for the given array data.
+         */
+        constexpr void reset(std::string_view array) {
+            m_array = array;
+            m_count = 0;
+            m_size = npos;
+        }
+
+        constexpr std::size_t stride() const {
+            return m_stride;
+        }
+
+        /**
+         * Returns the number of offsets recorded.
+         */
+        constexpr std::size_t count() const {
+            return m_count;
+        }
+
+        /**
+         * Returns the offset of entry n * stride().
+         */
+        constexpr std::size_t offset(std::size_t n) const {
+            return m_offsets[n];
+        }
+
+        /**
+         * Returns the number of entries in the array, if the end of the
+         * array has been reached.
+         */
+        constexpr std::optional<std::size_t> size() const {
+            if (m_size == npos)
+                return {};
+            return m_size;
+        }
+
+        /**
+         * Records the offset of the given entry, if it is the next to be kept
+         * and there is room.
+         */
+        constexpr void record(std::size_t entry, std::size_t offset) {
+            if (entry == m_count * m_stride && m_count < m_offsets.size())
+                m_offsets[m_count++] = static_cast<std::uint32_t>(offset);
+        }
+
+        /**
+         * Records the number of entries in the array.
+         */
+        constexpr void end(std::size_t size) {
+            m_size = size;
+        }
+    };
+}
+
+#endif // MINJSON_ARRAYINDEX_HPP_
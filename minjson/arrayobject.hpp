@@ -17,8 +17,13 @@
 #ifndef MINJSON_ARRAYOBJECT_HPP_
 #define MINJSON_ARRAYOBJECT_HPP_
 
+#include "arrayindex.hpp"
+#include "charclass.hpp"
 #include "objectbase.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <string_view>
 
 namespace minjson
@@ -33,26 +38,176 @@ namespace minjson
 
         std::string_view m_whole;
         std::size_t m_index;
+        std::size_t m_position; // Index of the current entry
         bool m_valid;
 
     public:
-        constexpr arrayobject(std::string_view whole)
-            : m_whole(whole), m_index(0), m_valid(false)
+        constexpr arrayobject(std::string_view whole,
+                              const structuralindex *structure = nullptr,
+                              bool padded = false)
+            : objectbase(minjson::type::null, {}, structure,
+                         minjson::numberkind::floating, padded),
+              m_whole(whole), m_index(0), m_position(0), m_valid(false)
         {
             // Load the first entry
-            next();
+            read();
         }
 
         constexpr bool valid() const {
             return m_valid;
         }
 
+        /**
+         * Returns the index of the current entry within the array.
+         */
+        constexpr std::size_t position() const {
+            return m_position;
+        }
+
         constexpr void rewind() {
             m_index = 0;
-            next();
+            m_position = 0;
+            read();
+        }
+
+        constexpr arrayobject& next() {
+            m_position++;
+            return read();
+        }
+
+        /**
+         * Moves forward by the given number of entries; skip(1) is next().
+         * Entries passed over do not have their type determined.
+         */
+        constexpr arrayobject& skip(std::size_t n) {
+            if (!m_valid || n == 0)
+                return *this;
+
+            auto offset = m_index != npos ? entryAt(m_index) : npos;
+            for (; n > 1 && offset != npos; n--, m_position++)
+                offset = after(offset);
+
+            m_index = offset;
+            return next();
+        }
+
+        /**
+         * Gives the entry at the given index, from which iteration may
+         * continue. Entries passed over do not have their type determined.
+         * @return The entry, which is not valid() if there is no such entry
+         */
+        constexpr arrayobject at(std::size_t i) const {
+            return seek(i, nullptr);
+        }
+
+        /**
+         * Gives the entry at the given index, using and filling the given
+         * index of this array's entries.
+         * @return The entry, which is not valid() if there is no such entry
+         */
+        constexpr arrayobject at(std::size_t i, arrayindex& index) const {
+            return seek(i, &index);
+        }
+
+        /**
+         * Counts the entries of the array a block at a time, by counting the
+         * commas outside of strings and nested objects and arrays. Entries
+         * are not read.
+         */
+        constexpr std::size_t count() const;
+
+        /**
+         * Counts the entries of the array; see count().
+         */
+        constexpr std::size_t size() const {
+            return count();
+        }
+
+        /**
+         * Counts the entries of the array, keeping the count in the given
+         * index of this array's entries.
+         */
+        constexpr std::size_t size(arrayindex& index) const {
+            prepare(index);
+            if (!index.size())
+                index.end(count());
+            return *index.size();
+        }
+
+    private:
+        constexpr arrayobject& read() {
+            return m_padded ? read<true>() : read<false>();
+        }
+
+        template<bool Padded>
+        constexpr arrayobject& read();
+
+        /**
+         * Gives the offset of the entry at or after the given offset, or npos
+         * at the end of the array.
+         */
+        constexpr std::size_t entryAt(std::size_t offset) const {
+            offset = firstNonSpace(m_whole, offset);
+            return offset != npos && m_whole[offset] != ']' ? offset : npos;
         }
 
-        constexpr arrayobject& next();
+        /**
+         * Gives the offset of the entry after the one at the given offset, or
+         * npos if it is the last.
+         */
+        constexpr std::size_t after(std::size_t offset) const;
+
+        /**
+         * Resets the given index if it does not hold this array.
+         */
+        constexpr void prepare(arrayindex& index) const {
+            if (!index.holds(m_whole)) {
+                index.reset(m_whole);
+                if (auto offset = entryAt(0); offset != npos)
+                    index.record(0, offset);
+                else
+                    index.end(0);
+            }
+        }
+
+        /**
+         * Finds the entry at the given index, starting from the closest
+         * offset in the index if one is given.
+         */
+        constexpr arrayobject seek(std::size_t i, arrayindex *index) const {
+            std::size_t position = 0;
+            auto offset = entryAt(0);
+            if (index) {
+                prepare(*index);
+                if (index->size() && i >= *index->size()) {
+                    offset = npos;
+                } else if (index->count() > 0) {
+                    const auto n = std::min(i / index->stride(), index->count() - 1);
+                    position = n * index->stride();
+                    offset = index->offset(n);
+                }
+            }
+
+            while (offset != npos && position < i) {
+                offset = after(offset);
+                if (offset != npos) {
+                    position++;
+                    if (index)
+                        index->record(position, offset);
+                } else if (index) {
+                    index->end(position + 1);
+                }
+            }
+
+            arrayobject entry = *this;
+            entry.m_index = offset;
+            entry.m_position = i;
+            if (offset != npos)
+                entry.read();
+            else
+                entry.m_valid = false;
+            return entry;
+        }
     };
 }
 
@@ -60,18 +215,28 @@ namespace minjson
 
 namespace minjson
 {
-    constexpr arrayobject& arrayobject::next()
+    template<bool Padded>
+    constexpr arrayobject& arrayobject::read()
     {
+        if (m_index != npos)
+            m_index = firstNonSpace<Padded>(m_whole, m_index);
+
         if (m_index == npos) {
             m_valid = false;
-        } else if (auto pair = parser::determineType(m_whole.substr(m_index)); pair) {
+        } else if (auto pair = parser::determineType<Padded>(m_whole.substr(m_index),
+                                                             m_structure, &m_kind);
+                   pair)
+        {
             // Found next entry in array; become it
             std::size_t next;
             std::tie(m_type, next) = *pair;
             m_value = m_whole.substr(m_index, next);
-            m_index = m_whole.find_first_not_of(" \t\n\r", m_index + next + 1);
 
-            if (m_index != npos && m_whole[m_index] == ']')
+            // Move past the following comma, or finish if there is none
+            m_index = firstNonSpace<Padded>(m_whole, m_index + next);
+            if (m_index != npos && m_whole[m_index] == ',')
+                m_index++;
+            else
                 m_index = npos;
             m_valid = true;
         } else {
@@ -82,5 +247,52 @@ namespace minjson
     }
 }
 
+namespace minjson
+{
+    constexpr std::size_t arrayobject::after(std::size_t offset) const
+    {
+        const auto comma = parser::skipValue(m_whole, offset, m_structure);
+        return comma != npos ? entryAt(comma + 1) : npos;
+    }
+
+    constexpr std::size_t arrayobject::count() const
+    {
+        if (entryAt(0) == npos)
+            return 0;
+
+        simd::stringstate state;
+        int depth = 0;
+        std::size_t commas = 0;
+        for (std::size_t from = 0; from < m_whole.size(); from += simd::blocksize) {
+            const auto m = simd::classify(m_whole.data() + from,
+                std::min(simd::blocksize, m_whole.size() - from));
+            const auto outside = ~simd::stringMasks(m, state).second;
+            const auto comma = m.comma & outside;
+
+            // Depth only changes at brackets, so the commas between each
+            // pair of brackets are counted at once
+            std::uint64_t counted = 0;
+            for (auto brackets = (m.open | m.close) & outside; brackets != 0;
+                 brackets &= brackets - 1)
+            {
+                const auto bit = std::uint64_t(1) << std::countr_zero(brackets);
+                if (depth == 0)
+                    commas += std::popcount(comma & (bit - 1) & ~counted);
+                counted = (bit - 1) | bit;
+
+                if ((m.open & bit) != 0)
+                    depth++;
+                else if (--depth < 0)
+                    return commas + 1;
+            }
+
+            if (depth == 0)
+                commas += std::popcount(comma & ~counted);
+        }
+
+        return commas + 1;
+    }
+}
+
 #endif // MINJSON_ARRAYOBJECT_HPP_
 
@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_CHARCLASS_HPP_
+#define MINJSON_CHARCLASS_HPP_
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * The classes of characters that matter to the parser. The classes found
+     * within numbers come first, so that they can index a table directly.
+     */
+    enum class charclass : std::uint8_t
+    {
+        other,
+        zero,     // '0'
+        digit,    // '1' to '9'
+        minus,
+        plus,
+        dot,
+        exponent, // 'e' or 'E'
+        space,    // ' ', '\t', '\r' or '\n'
+        quote,
+        object,   // '{'
+        array,    // '['
+        literal   // 't', 'f' or 'n': the start of true, false or null
+    };
+
+    /**
+     * The class of each character, indexed by its unsigned value.
+     */
+    constexpr auto charclasses = [] {
+        std::array<charclass, 256> table {};
+        table['0'] = charclass::zero;
+        for (int c = '1'; c <= '9'; c++)
+            table[c] = charclass::digit;
+        table['-'] = charclass::minus;
+        table['+'] = charclass::plus;
+        table['.'] = charclass::dot;
+        table['e'] = charclass::exponent;
+        table['E'] = charclass::exponent;
+        for (auto c : {' ', '\t', '\r', '\n'})
+            table[static_cast<unsigned char>(c)] = charclass::space;
+        table['\"'] = charclass::quote;
+        table['{'] = charclass::object;
+        table['['] = charclass::array;
+        table['t'] = charclass::literal;
+        table['f'] = charclass::literal;
+        table['n'] = charclass::literal;
+        return table;
+    }();
+
+    /**
+     * Gives the class of the given character.
+     */
+    constexpr charclass classOf(char c) {
+        return charclasses[static_cast<unsigned char>(c)];
+    }
+
+    /**
+     * Finds the first character at or after from that is not whitespace.
+     * @tparam Padded If true, the string must lie within a paddedview; its
+     *                end is then only tested once, after the scan
+     * @return The character's index, or std::string_view::npos if none
+     */
+    template<bool Padded = false>
+    constexpr std::size_t firstNonSpace(std::string_view str, std::size_t from = 0) {
+        if constexpr (Padded) {
+            // The padding ends any run of whitespace
+            while (classOf(str.data()[from]) == charclass::space)
+                from++;
+            return from < str.size() ? from : std::string_view::npos;
+        } else {
+            for (; from < str.size(); from++) {
+                if (classOf(str[from]) != charclass::space)
+                    return from;
+            }
+
+            return std::string_view::npos;
+        }
+    }
+
+    /**
+     * Finds the last character that is not whitespace.
+     * @return The character's index, or std::string_view::npos if none
+     */
+    constexpr std::size_t lastNonSpace(std::string_view str) {
+        for (auto i = str.size(); i > 0; i--) {
+            if (classOf(str[i - 1]) != charclass::space)
+                return i - 1;
+        }
+
+        return std::string_view::npos;
+    }
+}
+
+#endif // MINJSON_CHARCLASS_HPP_
@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_CURSOR_HPP_
+#define MINJSON_CURSOR_HPP_
+
+#include "charclass.hpp"
+#include "object.hpp"
+#include "parser.hpp"
+#include "structuralindex.hpp"
+
+#include <optional>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * Reads the members of an object on demand, moving forward only. Members
+     * passed over by find() are skipped by counting brackets, so only the
+     * values asked for have their type determined.
+     *
+     * With a structural index, skipping jumps between structural characters;
+     * with a document, over whole objects and arrays at once.
+     */
+    class cursor
+    {
+    private:
+        constexpr static auto npos = std::string_view::npos;
+
+        std::string_view m_body; // The object's contents, between its braces
+        const structuralindex *m_structure;
+        std::size_t m_index; // Just past the last value read
+        bool m_ready;
+
+    public:
+        constexpr cursor() :
+            m_structure(nullptr), m_index(0), m_ready(false) {}
+
+        /**
+         * Reads the object that the given parser was started on, from its
+         * beginning.
+         * @param p A parser that is ready()
+         */
+        constexpr cursor(const parser& p) :
+            m_body(p.m_body), m_structure(p.m_structure), m_index(0),
+            m_ready(p.m_ready) {}
+
+        /**
+         * Tells if the cursor has an object to read.
+         */
+        constexpr bool ready() const {
+            return m_ready;
+        }
+
+        /**
+         * Moves back to the beginning of the object.
+         */
+        constexpr void rewind() {
+            m_index = 0;
+        }
+
+        /**
+         * Finds the next member with the given name, searching forward from
+         * the last member found. Members skipped on the way can only be
+         * found again after rewind().
+         * @param key Name of the member, as it appears within its quotes
+         * @return The member; or nothing if there is no such member ahead or
+         *         the data is invalid, which leaves the cursor in place
+         */
+        constexpr std::optional<object> find(std::string_view key) {
+            if (!m_ready)
+                return {};
+
+            const auto base = m_structure ? m_structure->offsetOf(m_body) : npos;
+            for (auto index = m_index; ;) {
+                auto i = firstNonSpace(m_body, index);
+                if (i != npos && m_body[i] == ',')
+                    i = firstNonSpace(m_body, i + 1);
+                if (i == npos || m_body[i] != '\"')
+                    return {};
+
+                // Find the end of the key, then its value
+                auto end = npos;
+                if (m_structure) {
+                    end = m_structure->next(base + i + 1);
+                    end = end != npos ? end - base : npos;
+                } else {
+                    end = parser::stringEnd(m_body, i + 1);
+                }
+
+                const auto colon = end < m_body.size() ? firstNonSpace(m_body, end + 1) : npos;
+                if (colon == npos || m_body[colon] != ':')
+                    return {};
+                const auto value = firstNonSpace(m_body, colon + 1);
+                if (value == npos)
+                    return {};
+
+                const auto name = m_body.substr(i + 1, end - i - 1);
+                if (name == key) {
+                    auto kind = numberkind::floating;
+                    auto pair = parser::determineType(m_body.substr(value), m_structure, &kind);
+                    if (!pair)
+                        return {};
+
+                    m_index = value + pair->second;
+                    return object {
+                        name,
+                        pair->first,
+                        m_body.substr(value, pair->second),
+                        m_structure,
+                        kind
+                    };
+                }
+
+                index = parser::skipValue(m_body, value, m_structure);
+                if (index == npos)
+                    return {};
+            }
+        }
+    };
+}
+
+#endif // MINJSON_CURSOR_HPP_
@@ -0,0 +1,416 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_DECIMAL_HPP_
+#define MINJSON_DECIMAL_HPP_
+
+#include "powers.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cfloat>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace minjson
+{
+    /**
+     * A JSON number split into its parts: up to 19 significant digits, and a
+     * power of ten. Used to convert numbers to C++ types.
+     */
+    class decimal
+    {
+    public:
+        std::uint64_t mantissa = 0;
+        int exponent = 0;
+        bool negative = false;
+        bool truncated = false;  // Set if digits beyond the 19th were dropped
+        std::string_view text;   // The number as written
+
+        /**
+         * Tells if the eight characters of the given word are all digits.
+         */
+        constexpr static bool isEightDigits(std::uint64_t word) {
+            return ((word & 0xf0f0f0f0f0f0f0f0) |
+                    (((word + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) ==
+                0x3333333333333333;
+        }
+
+        /**
+         * Converts eight digit characters, held little-endian in a word, to
+         * their value in three multiplications.
+         */
+        constexpr static std::uint32_t parseEightDigits(std::uint64_t word) {
+            constexpr std::uint64_t mask = 0x000000ff000000ff;
+            constexpr std::uint64_t mul1 = 0x000f424000000064; // 100 + (1000000 << 32)
+            constexpr std::uint64_t mul2 = 0x0000271000000001; // 1 + (10000 << 32)
+            word -= 0x3030303030303030;
+            word = (word * 10) + (word >> 8);
+            return static_cast<std::uint32_t>(
+                (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32);
+        }
+
+        /**
+         * Splits the number at the start of the given string into its parts.
+         * @param str String beginning with a number
+         * @return The parts of the number, or nothing if there are no digits
+         */
+        constexpr static std::optional<decimal> parse(std::string_view str) {
+            decimal d;
+            const auto size = str.size();
+            std::size_t i = 0;
+
+            auto digitAt = [&str, size](std::size_t j) {
+                return j < size && str[j] >= '0' && str[j] <= '9';
+            };
+            auto takeDigits = [&] {
+                for (; i + 8 <= size; i += 8) {
+                    const auto word = simd::loadWord(str.data() + i);
+                    if (!isEightDigits(word))
+                        break;
+                    d.mantissa = d.mantissa * 100000000 + parseEightDigits(word);
+                }
+                for (; digitAt(i); i++)
+                    d.mantissa = d.mantissa * 10 + static_cast<unsigned>(str[i] - '0');
+            };
+
+            d.negative = size > 0 && str[0] == '-';
+            i += d.negative;
+
+            // Digits are accumulated without regard for overflow; numbers with
+            // too many digits are then parsed again, below.
+            const auto integer = i;
+            takeDigits();
+            auto digits = i - integer;
+
+            if (i < size && str[i] == '.') {
+                const auto fraction = ++i;
+                takeDigits();
+                digits += i - fraction;
+                d.exponent = -static_cast<int>(i - fraction);
+            }
+
+            if (digits == 0)
+                return {};
+
+            if (i < size && (str[i] == 'e' || str[i] == 'E')) {
+                auto j = i + 1;
+                bool negativeExponent = false;
+                if (j < size && (str[j] == '-' || str[j] == '+'))
+                    negativeExponent = str[j++] == '-';
+
+                if (digitAt(j)) {
+                    int e = 0;
+                    for (; digitAt(j); j++) {
+                        if (e < 100000)
+                            e = e * 10 + (str[j] - '0');
+                    }
+                    d.exponent += negativeExponent ? -e : e;
+                    i = j;
+                }
+            }
+
+            d.text = str.substr(0, i);
+            if (digits > 19) {
+                // Leading zeros are not significant
+                for (auto j = integer; j < i && (str[j] == '0' || str[j] == '.'); j++)
+                    digits -= str[j] == '0';
+                if (digits > 19)
+                    d.truncate(str.substr(integer, i - integer));
+            }
+            return d;
+        }
+
+        /**
+         * Converts to the given floating-point type, correctly rounded.
+         *
+         * Numbers with a mantissa and power of ten that are both exactly
+         * representable are converted with a single multiplication or
+         * division (Clinger's fast path). Most others are converted with a
+         * 128-bit multiplication by a power of five (the Eisel-Lemire
+         * algorithm). The rare number that neither can round correctly is
+         * given to std::from_chars, except during constant evaluation where
+         * a close approximation is made instead.
+         */
+        template<typename T>
+        constexpr T toFloat() const {
+            static_assert(std::is_floating_point_v<T>);
+
+            if (mantissa == 0)
+                return negative ? -T(0) : T(0);
+
+            // Without exact arithmetic (e.g. x87) the fast path may round twice
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0 || FLT_EVAL_METHOD == 1)
+            constexpr bool exact = std::numeric_limits<T>::digits <= 53;
+#else
+            constexpr bool exact = false;
+#endif
+            if constexpr (exact) {
+                // Largest power of ten that T represents exactly
+                constexpr int maxPower = std::numeric_limits<T>::digits == 24 ? 10 : 22;
+                constexpr auto maxMantissa = std::uint64_t(1) << std::numeric_limits<T>::digits;
+
+                auto m = mantissa;
+                auto e = exponent;
+                if (!truncated && e > maxPower) {
+                    // Move excess powers of ten into the mantissa, if exact
+                    for (; e > maxPower && m <= maxMantissa / 10; e--)
+                        m *= 10;
+                }
+
+                if (!truncated && m <= maxMantissa && e >= -maxPower && e <= maxPower) {
+                    T value = static_cast<T>(m);
+                    if (e < 0)
+                        value /= powerOfTen<T>(-e);
+                    else
+                        value *= powerOfTen<T>(e);
+                    return negative ? -value : value;
+                }
+            }
+
+            if constexpr (std::numeric_limits<T>::is_iec559 &&
+                          (std::is_same_v<T, float> || std::is_same_v<T, double>))
+            {
+                // A truncated mantissa is only safe to use if rounding it up
+                // would give the same result
+                auto bits = eiselLemire<T>(mantissa, exponent);
+                if (truncated && bits && bits != eiselLemire<T>(mantissa + 1, exponent))
+                    bits.reset();
+
+                if (bits) {
+                    using word = std::conditional_t<std::is_same_v<T, float>,
+                                                    std::uint32_t, std::uint64_t>;
+                    constexpr auto sign = word(1) << (sizeof(word) * 8 - 1);
+                    return std::bit_cast<T>(static_cast<word>(*bits) | (negative ? sign : 0));
+                }
+            }
+
+            if (!std::is_constant_evaluated()) {
+#if defined(__cpp_lib_to_chars)
+                T value {};
+                auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+                if (ec == std::errc())
+                    return value;
+                else if (ec == std::errc::result_out_of_range)
+                    return overflow<T>();
+#else
+                char buffer[64];
+                if (text.size() < sizeof(buffer)) {
+                    std::copy(text.begin(), text.end(), buffer);
+                    buffer[text.size()] = '\0';
+                    if constexpr (std::is_same_v<T, float>)
+                        return std::strtof(buffer, nullptr);
+                    else if constexpr (std::is_same_v<T, double>)
+                        return std::strtod(buffer, nullptr);
+                    else
+                        return std::strtold(buffer, nullptr);
+                }
+#endif
+            }
+
+            // Approximation through long double
+            if (exponent > std::numeric_limits<T>::max_exponent10 + 20)
+                return overflow<T>();
+            if (exponent < std::numeric_limits<T>::min_exponent10 - 40)
+                return negative ? -T(0) : T(0);
+
+            long double value = static_cast<long double>(mantissa);
+            for (auto e = exponent; e > 0; e--)
+                value *= 10;
+            for (auto e = exponent; e < 0; e++)
+                value /= 10;
+            return static_cast<T>(negative ? -value : value);
+        }
+
+        /**
+         * Multiplies two 64-bit numbers.
+         * @return A pair of the high and low 64 bits of the product
+         */
+        constexpr static std::pair<std::uint64_t, std::uint64_t>
+            multiply(std::uint64_t a, std::uint64_t b)
+        {
+#if defined(__SIZEOF_INT128__)
+            __extension__ typedef unsigned __int128 wide;
+            const auto product = static_cast<wide>(a) * b;
+            return {static_cast<std::uint64_t>(product >> 64),
+                    static_cast<std::uint64_t>(product)};
+#else
+            const auto lo = [](std::uint64_t x) { return x & 0xffffffff; };
+            const auto ll = lo(a) * lo(b);
+            const auto lh = lo(a) * (b >> 32);
+            const auto hl = (a >> 32) * lo(b);
+            const auto hh = (a >> 32) * (b >> 32);
+            const auto middle = (ll >> 32) + lo(lh) + lo(hl);
+            return {hh + (lh >> 32) + (hl >> 32) + (middle >> 32),
+                    (middle << 32) | lo(ll)};
+#endif
+        }
+
+    private:
+        /**
+         * Rebuilds the mantissa from the first 19 significant digits of the
+         * given number (without its sign), moving the rest into the exponent.
+         */
+        constexpr void truncate(std::string_view digits) {
+            int exp = 0;
+            int kept = 0;
+            mantissa = 0;
+
+            std::size_t i = 0;
+            bool fraction = false;
+            for (; i < digits.size(); i++) {
+                const char c = digits[i];
+                if (c == '.') {
+                    fraction = true;
+                } else if (c < '0' || c > '9') {
+                    break;
+                } else if (kept < 19) {
+                    mantissa = mantissa * 10 + static_cast<unsigned>(c - '0');
+                    kept += mantissa != 0;
+                    exp -= fraction;
+                } else {
+                    truncated |= c != '0';
+                    exp += !fraction;
+                }
+            }
+
+            // Keep the explicit exponent, which follows the digits
+            int e = 0;
+            bool negativeExponent = false;
+            if (i < digits.size()) {
+                for (auto c : digits.substr(i + 1)) {
+                    if (c == '-')
+                        negativeExponent = true;
+                    else if (c >= '0' && c <= '9' && e < 100000)
+                        e = e * 10 + (c - '0');
+                }
+            }
+
+            exponent = exp + (negativeExponent ? -e : e);
+        }
+
+        /**
+         * Converts w * 10^q to float or double with the Eisel-Lemire
+         * algorithm, following the fast_float library.
+         * @return The value's bits without its sign, or nothing if the result
+         *         cannot be rounded correctly this way
+         */
+        template<typename T>
+        constexpr static std::optional<std::uint64_t> eiselLemire(std::uint64_t w, int q)
+        {
+            constexpr bool single = std::is_same_v<T, float>;
+            constexpr int mantissaBits = single ? 23 : 52;
+            constexpr int minimumExponent = single ? -127 : -1023;
+            constexpr int infinitePower = single ? 0xff : 0x7ff;
+            constexpr int smallestPower = single ? -65 : powers::smallest;
+            constexpr int largestPower = single ? 38 : powers::largest;
+            constexpr int minEvenPower = single ? -17 : -4;
+            constexpr int maxEvenPower = single ? 10 : 23;
+            constexpr auto infinity = std::uint64_t(infinitePower) << mantissaBits;
+
+            if (w == 0 || q < smallestPower)
+                return 0;
+            if (q > largestPower)
+                return infinity;
+
+            const auto zeros = std::countl_zero(w);
+            w <<= zeros;
+
+            // Multiply by the truncated power of five, using its low half only
+            // when the high half of the product may be too imprecise
+            const auto index = 2 * (q - powers::smallest);
+            auto [high, low] = multiply(w, powers::fives[index]);
+            constexpr auto precision = ~std::uint64_t(0) >> (mantissaBits + 3);
+            if ((high & precision) == precision) {
+                const auto second = multiply(w, powers::fives[index + 1]).first;
+                low += second;
+                high += low < second;
+            }
+
+            const int upper = static_cast<int>(high >> 63);
+            const int shift = upper + 64 - mantissaBits - 3;
+            auto mantissa = high >> shift;
+            // floor(log2(10^q)) + 63, from a fixed-point approximation
+            int power2 = (((152170 + 65536) * q) >> 16) + 63 + upper - zeros - minimumExponent;
+
+            if (power2 <= 0) {
+                // Subnormal, or too small to be represented
+                if (-power2 + 1 >= 64)
+                    return 0;
+                mantissa >>= -power2 + 1;
+                mantissa += mantissa & 1;
+                mantissa >>= 1;
+                power2 = mantissa < (std::uint64_t(1) << mantissaBits) ? 0 : 1;
+                return mantissa | (std::uint64_t(power2) << mantissaBits);
+            }
+
+            // Exactly halfway between two values: round to even
+            if (low <= 1 && q >= minEvenPower && q <= maxEvenPower &&
+                (mantissa & 3) == 1 && (mantissa << shift) == high)
+            {
+                mantissa &= ~std::uint64_t(1);
+            }
+
+            mantissa += mantissa & 1;
+            mantissa >>= 1;
+            if (mantissa >= (std::uint64_t(2) << mantissaBits)) {
+                mantissa = std::uint64_t(1) << mantissaBits;
+                power2++;
+            }
+
+            if (power2 >= infinitePower)
+                return infinity;
+
+            mantissa &= ~(std::uint64_t(1) << mantissaBits);
+            return mantissa | (std::uint64_t(power2) << mantissaBits);
+        }
+
+        /**
+         * Gives 10^n, exactly, for n within the range used by toFloat().
+         */
+        template<typename T>
+        constexpr static T powerOfTen(int n) {
+            constexpr std::array<double, 23> powers {
+                1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+            return static_cast<T>(powers[n]);
+        }
+
+        /**
+         * Gives the result for a number too large (or small) for T.
+         */
+        template<typename T>
+        constexpr T overflow() const {
+            if (exponent < 0)
+                return negative ? -T(0) : T(0);
+
+            auto inf = std::numeric_limits<T>::infinity();
+            return negative ? -inf : inf;
+        }
+    };
+}
+
+#endif // MINJSON_DECIMAL_HPP_
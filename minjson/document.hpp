@@ -0,0 +1,133 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_DOCUMENT_HPP_
+#define MINJSON_DOCUMENT_HPP_
+
+#include "structuralindex.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * A structural index that also records, for every '{' and '[', the
+     * position of its matching close. Skipping over an object or array then
+     * takes a table lookup rather than a scan of its contents, so nested
+     * values are no longer rescanned once per level of nesting.
+     *
+     * Like structuralindex, all storage is provided by the caller.
+     */
+    class document : public structuralindex
+    {
+    private:
+        constexpr static auto none = std::numeric_limits<std::uint32_t>::max();
+
+    public:
+        /**
+         * Gives an upper bound on the number of entries of table storage
+         * needed for the given JSON data. Each opening bracket needs a closing
+         * one, so there are at most half as many as there are characters.
+         */
+        constexpr static std::size_t tableSize(std::string_view json) {
+            return storageSize(json.size()) + json.size() / 2 + 1;
+        }
+
+        constexpr document() = default;
+
+        /**
+         * Builds the index and jump table for the given JSON data.
+         * @param json The JSON data, which must outlive the document
+         * @param storage Storage for the bitmap, of at least storageSize() words
+         * @param table Storage for the jump table, of at least tableSize() entries
+         * @param check Validation to do while indexing, in the same pass
+         * @return True if successful; false if storage is too small, if a
+         *         string or bracket is left unterminated, a bracket is
+         *         closed by the wrong kind, or validation fails
+         */
+        constexpr bool build(std::string_view json,
+                             std::span<std::uint64_t> storage,
+                             std::span<std::uint32_t> table,
+                             validation check = validation::none)
+        {
+            if (json.size() >= none || !structuralindex::build(json, storage, check))
+                return false;
+
+            auto fail = [this] {
+                m_json = {};
+                m_bits = {};
+                m_utf8 = false;
+                return false;
+            };
+
+            const auto words = m_bits.size();
+            if (table.size() < words)
+                return fail();
+
+            // Closers are stored after the per-block ranks. While a bracket is
+            // open, its entry instead holds one past the entry of its parent
+            // bracket shifted left by one, with the low bit set for '['.
+            // More than half the data in openers can never all be closed, so
+            // capping the count there keeps the shift from overflowing.
+            auto ranks = table.first(words);
+            auto closers = table.subspan(words);
+            std::uint32_t count = 0;
+            std::uint32_t top = none;
+            for (std::size_t word = 0; word < words; word++) {
+                ranks[word] = count;
+                for (auto bits = m_bits[word]; bits != 0; bits &= bits - 1) {
+                    const auto pos = word * simd::blocksize + std::countr_zero(bits);
+                    switch (m_json[pos]) {
+                    case '{':
+                    case '[':
+                        if (count >= closers.size() || count >= none / 2)
+                            return fail();
+                        closers[count] = ((top + 1) << 1) | (m_json[pos] == '[');
+                        top = count++;
+                        break;
+                    case '}':
+                    case ']':
+                        if (top == none) {
+                            return fail();
+                        } else {
+                            const auto open = closers[top];
+                            if ((open & 1) != (m_json[pos] == ']'))
+                                return fail();
+                            closers[top] = static_cast<std::uint32_t>(pos);
+                            top = (open >> 1) - 1;
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+
+            if (top != none)
+                return fail();
+
+            m_ranks = ranks;
+            m_closers = closers.first(count);
+            return true;
+        }
+    };
+}
+
+#endif // MINJSON_DOCUMENT_HPP_
@@ -0,0 +1,179 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_ESCAPE_HPP_
+#define MINJSON_ESCAPE_HPP_
+
+#include "simd.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * Escapes a string for use within JSON quotes. Quotes, backslashes and
+     * control characters are escaped; all else is copied as is, whole
+     * blocks at a time where there is nothing to escape.
+     * @param str The string
+     * @param out Where to write the result
+     * @return The size of the result, or nothing if it does not fit in out
+     */
+    constexpr std::optional<std::size_t> escape(std::string_view str, std::span<char> out)
+    {
+        constexpr char hex[] = "0123456789abcdef";
+
+        std::size_t in = 0;
+        std::size_t size = 0;
+        while (true) {
+            // Copy up to the next character to escape
+            const auto n = simd::copyPlain(str.substr(in), out.data() + size,
+                                           out.size() - size);
+            in += n;
+            size += n;
+            if (in == str.size())
+                return size;
+
+            const auto u = static_cast<unsigned char>(str[in++]);
+            char sequence[6] = { '\\', static_cast<char>(u), '0', '0', 0, 0 };
+            std::size_t length = 2;
+            switch (u) {
+            case '\"':
+            case '\\': break;
+            case '\b': sequence[1] = 'b'; break;
+            case '\f': sequence[1] = 'f'; break;
+            case '\n': sequence[1] = 'n'; break;
+            case '\r': sequence[1] = 'r'; break;
+            case '\t': sequence[1] = 't'; break;
+            default:
+                sequence[1] = 'u';
+                sequence[4] = hex[u >> 4];
+                sequence[5] = hex[u & 15];
+                length = 6;
+                break;
+            }
+
+            if (length > out.size() - size)
+                return {};
+            for (std::size_t i = 0; i < length; i++)
+                out[size++] = sequence[i];
+        }
+    }
+
+    /**
+     * Replaces the escape sequences of a JSON string with the characters
+     * they stand for. \\uXXXX sequences, including surrogate pairs, are
+     * written as UTF-8. The output is never longer than the input.
+     * @param str The string's contents, without its quotes
+     * @param out Where to write the result
+     * @return The size of the result, or nothing if an escape is invalid or
+     *         the result does not fit in out
+     */
+    constexpr std::optional<std::size_t> unescape(std::string_view str, std::span<char> out)
+    {
+        // Reads four hex digits at the given index
+        auto hex = [str](std::size_t i) -> std::optional<std::uint32_t> {
+            if (i + 4 > str.size())
+                return {};
+
+            std::uint32_t value = 0;
+            for (auto c : str.substr(i, 4)) {
+                value <<= 4;
+                if (c >= '0' && c <= '9')
+                    value |= c - '0';
+                else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+                    value |= (c | 0x20) - 'a' + 10;
+                else
+                    return {};
+            }
+            return value;
+        };
+
+        std::size_t in = 0;
+        std::size_t size = 0;
+        while (true) {
+            // Copy up to the next backslash
+            const auto n = simd::copyUntil(str.substr(in), out.data() + size,
+                                           out.size() - size, '\\');
+            in += n;
+            size += n;
+            if (in == str.size())
+                return size;
+            else if (str[in] != '\\' || in + 1 == str.size())
+                return {};
+
+            const char c = str[in + 1];
+            in += 2;
+
+            std::uint32_t point;
+            switch (c) {
+            case '\"':
+            case '\\':
+            case '/': point = static_cast<unsigned char>(c); break;
+            case 'b': point = '\b'; break;
+            case 'f': point = '\f'; break;
+            case 'n': point = '\n'; break;
+            case 'r': point = '\r'; break;
+            case 't': point = '\t'; break;
+            case 'u':
+                if (auto h = hex(in); h) {
+                    point = *h;
+                    in += 4;
+                } else {
+                    return {};
+                }
+
+                // A high surrogate must be followed by an escaped low one
+                if (point >= 0xdc00 && point <= 0xdfff) {
+                    return {};
+                } else if (point >= 0xd800 && point <= 0xdbff) {
+                    auto low = in + 1 < str.size() && str[in] == '\\' && str[in + 1] == 'u'
+                        ? hex(in + 2) : std::nullopt;
+                    if (!low || *low < 0xdc00 || *low > 0xdfff)
+                        return {};
+
+                    point = 0x10000 + ((point - 0xd800) << 10) + (*low - 0xdc00);
+                    in += 6;
+                }
+                break;
+            default:
+                return {};
+            }
+
+            // Write the character as UTF-8
+            const std::size_t length = point < 0x80 ? 1 : point < 0x800 ? 2 :
+                                       point < 0x10000 ? 3 : 4;
+            if (length > out.size() - size)
+                return {};
+
+            if (length == 1) {
+                out[size] = static_cast<char>(point);
+            } else {
+                constexpr unsigned char leads[] = { 0, 0, 0xc0, 0xe0, 0xf0 };
+                for (auto i = length - 1; i > 0; i--) {
+                    out[size + i] = static_cast<char>(0x80 | (point & 0x3f));
+                    point >>= 6;
+                }
+                out[size] = static_cast<char>(leads[length] | point);
+            }
+            size += length;
+        }
+    }
+}
+
+#endif // MINJSON_ESCAPE_HPP_
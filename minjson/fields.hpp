@@ -0,0 +1,196 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_FIELDS_HPP_
+#define MINJSON_FIELDS_HPP_
+
+#include "fixedstring.hpp"
+#include "keycache.hpp"
+#include "objectbase.hpp"
+#include "parser.hpp"
+#include "type.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+namespace minjson
+{
+    /**
+     * Describes one field of a struct: the key it is read from, and the
+     * member it is stored in.
+     * @tparam Name The key
+     * @tparam Member Pointer to the member, e.g. &config::baud
+     * @tparam Binding The fields<...> of the member's type, if it is a struct
+     *                 read from a JSON object
+     */
+    template<fixedstring Name, auto Member, typename Binding = void>
+    struct field
+    {
+        constexpr static std::string_view name = Name.view();
+        constexpr static auto member = Member;
+        using binding = Binding;
+    };
+
+    /**
+     * Binds the members of a struct to the keys of a JSON object, e.g.
+     *
+     *     using binding = minjson::fields<
+     *         minjson::field<"baud", &uart::baud>,
+     *         minjson::field<"echo", &uart::echo>>;
+     *     binding::decode(parser, u);
+     *
+     * Keys are matched through a perfect hash found at compile time, so each
+     * key costs one hash and one comparison. Members may be bool, numbers,
+     * std::string_view, std::optional of those, or structs with a binding.
+     */
+    template<typename... Fields>
+    class fields
+    {
+    private:
+        constexpr static std::size_t count = sizeof...(Fields);
+        constexpr static std::array<std::string_view, count> names {Fields::name...};
+
+        /**
+         * Parameters of the hash (h * seed) >> (32 - bits), where h is the
+         * FNV-1a hash of the key.
+         */
+        struct perfecthash
+        {
+            std::uint32_t seed = 0;
+            unsigned bits = 0;
+
+            constexpr std::size_t operator()(std::string_view key) const {
+                return (keycache<1>::hash(key) * seed) >> (32 - bits);
+            }
+        };
+
+        /**
+         * Finds the smallest table, then the first seed, for which no two
+         * keys share a slot.
+         */
+        constexpr static perfecthash hash = [] {
+            unsigned bits = 1;
+            while ((std::size_t(1) << bits) < count)
+                bits++;
+
+            for (; bits <= 16; bits++) {
+                for (std::uint32_t seed = 1; seed < (1u << 16); seed += 2) {
+                    const perfecthash h {seed, bits};
+                    bool unique = true;
+                    for (std::size_t i = 0; unique && i < count; i++) {
+                        for (std::size_t j = 0; unique && j < i; j++)
+                            unique = h(names[i]) != h(names[j]);
+                    }
+                    if (unique)
+                        return h;
+                }
+            }
+
+            return perfecthash {};
+        }();
+
+        static_assert(hash.seed != 0, "field names must be unique");
+
+        /**
+         * Maps each slot of the hash to its field's index plus one, or zero
+         * if the slot is empty.
+         */
+        constexpr static auto slots = [] {
+            std::array<std::uint8_t, std::size_t(1) << hash.bits> s {};
+            for (std::size_t i = 0; i < count; i++)
+                s[hash(names[i])] = static_cast<std::uint8_t>(i + 1);
+            return s;
+        }();
+
+        static_assert(count < 256, "too many fields");
+
+        /**
+         * Reads a value into the given member.
+         * @return False if the value has the wrong type
+         */
+        template<typename Binding, typename M>
+        constexpr static bool assign(M& member, const objectbase& value) {
+            if constexpr (!std::is_void_v<Binding>) {
+                auto p = value.getObject();
+                return p && Binding::decode(*p, member);
+            } else if constexpr (requires { typename M::value_type; member.reset(); }) {
+                // std::optional: left empty if null
+                if (value.type() == type::null) {
+                    member.reset();
+                    return true;
+                }
+
+                typename M::value_type v {};
+                if (!assign<void>(v, value))
+                    return false;
+                member = v;
+                return true;
+            } else {
+                static_assert(numeric<M> || std::is_same_v<M, bool> ||
+                              std::is_same_v<M, std::string_view>,
+                              "member type cannot be read from JSON");
+                auto v = value.get<M>();
+                if (v)
+                    member = *v;
+                return v.has_value();
+            }
+        }
+
+        template<typename F, typename T>
+        constexpr static bool assignField(T& out, const objectbase& value) {
+            return assign<typename F::binding>(out.*F::member, value);
+        }
+
+        template<typename T>
+        using setter = bool (*)(T&, const objectbase&);
+
+        template<typename T>
+        constexpr static std::array<setter<T>, count> setters {&assignField<Fields, T>...};
+
+    public:
+        /**
+         * Reads the given parser's object into a struct, in a single pass.
+         * Keys without a field are skipped; fields without a key are left
+         * untouched. Fields are written as their keys are read, so on
+         * failure those read before the error have already been written.
+         * @param p Parser started on the object
+         * @param out The struct to fill
+         * @return False if the object is invalid, or a value has the wrong
+         *         type for its field
+         */
+        template<typename T>
+        constexpr static bool decode(parser p, T& out) {
+            while (p.ready()) {
+                // Failing before the end of the object means invalid data
+                auto o = p.next();
+                if (!o)
+                    return p.empty();
+
+                const auto name = o->name();
+                const auto slot = slots[hash(name)];
+                if (slot != 0 && names[slot - 1] == name && !setters<T>[slot - 1](out, *o))
+                    return false;
+            }
+
+            return true;
+        }
+    };
+}
+
+#endif // MINJSON_FIELDS_HPP_
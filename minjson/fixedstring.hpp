@@ -0,0 +1,49 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_FIXEDSTRING_HPP_
+#define MINJSON_FIXEDSTRING_HPP_
+
+#include <cstddef>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * A string literal that can be passed as a template argument, e.g.
+     * minjson::get<"/path">(...).
+     */
+    template<std::size_t N>
+    struct fixedstring
+    {
+        char data[N] {};
+
+        constexpr fixedstring(const char (&str)[N]) {
+            for (std::size_t i = 0; i < N; i++)
+                data[i] = str[i];
+        }
+
+        constexpr std::size_t size() const {
+            return N - 1;
+        }
+
+        constexpr std::string_view view() const {
+            return {data, N - 1};
+        }
+    };
+}
+
+#endif // MINJSON_FIXEDSTRING_HPP_
@@ -0,0 +1,320 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_FORMAT_HPP_
+#define MINJSON_FORMAT_HPP_
+
+#include "decimal.hpp"
+#include "powers.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Formats numbers as JSON text. Integers are written eight digits at a time;
+ * doubles are written with the fewest digits that read back to the same
+ * value, found with the Schubfach algorithm.
+ */
+namespace minjson::format
+{
+    /**
+     * The most characters written for any integer; e.g. -9223372036854775808.
+     */
+    constexpr std::size_t maxInteger = 20;
+
+    /**
+     * The most characters written for any double; e.g. -2.2250738585072014e-308.
+     */
+    constexpr std::size_t maxDouble = 24;
+
+    /**
+     * Converts a number below 10^8 to its eight decimal digits, one per byte
+     * with the first digit in the lowest byte. Each pair of steps divides
+     * every lane of the word at once (SWAR).
+     */
+    constexpr std::uint64_t eightDigits(std::uint32_t value)
+    {
+        // Lanes of 32 bits: the upper and lower four digits
+        std::uint64_t x = value / 10000 | std::uint64_t(value % 10000) << 32;
+        // Lanes of 16 bits: pairs of digits, by x / 100 in each lane
+        const auto hundreds = ((x * 10486) >> 20) & 0x0000007f0000007f;
+        x = hundreds | (x - hundreds * 100) << 16;
+        // Lanes of 8 bits: single digits, by x / 10 in each lane
+        const auto tens = ((x * 103) >> 10) & 0x000f000f000f000f;
+        return tens | (x - tens * 10) << 8;
+    }
+
+    /**
+     * Writes the last count digits of the given eightDigits() result.
+     */
+    constexpr void storeDigits(char *out, std::uint64_t digits, std::size_t count)
+    {
+        digits += 0x3030303030303030;
+        for (std::size_t i = 0; i < count; i++)
+            out[i] = static_cast<char>(digits >> (8 * (8 - count + i)));
+    }
+
+    /**
+     * Writes a number below 10^8 without leading zeros.
+     */
+    constexpr std::size_t leadingDigits(char *out, std::uint32_t value)
+    {
+        const auto digits = eightDigits(value);
+        const std::size_t count = value == 0 ? 1 : 8 - std::countr_zero(digits) / 8;
+        storeDigits(out, digits, count);
+        return count;
+    }
+
+    /**
+     * Writes an integer.
+     * @param out Where to write, with room for maxInteger characters
+     * @return The number of characters written
+     */
+    template<typename T>
+    constexpr std::size_t integer(char *out, T n)
+    {
+        static_assert(std::is_integral_v<T> && sizeof(T) <= 8);
+
+        auto u = static_cast<std::uint64_t>(n);
+        std::size_t size = 0;
+        if constexpr (std::is_signed_v<T>) {
+            if (n < 0) {
+                out[size++] = '-';
+                u = 0 - u;
+            }
+        }
+
+        constexpr std::uint64_t e8 = 100000000;
+        if (u < e8) {
+            size += leadingDigits(out + size, static_cast<std::uint32_t>(u));
+        } else if (u < e8 * e8) {
+            size += leadingDigits(out + size, static_cast<std::uint32_t>(u / e8));
+            storeDigits(out + size, eightDigits(static_cast<std::uint32_t>(u % e8)), 8);
+            size += 8;
+        } else {
+            size += leadingDigits(out + size, static_cast<std::uint32_t>(u / (e8 * e8)));
+            u %= e8 * e8;
+            storeDigits(out + size, eightDigits(static_cast<std::uint32_t>(u / e8)), 8);
+            storeDigits(out + size + 8, eightDigits(static_cast<std::uint32_t>(u % e8)), 8);
+            size += 16;
+        }
+
+        return size;
+    }
+
+    /**
+     * Writes the whole number c * 2^q exactly, for c below 2^53 and q up to
+     * 30. Beyond 2^64 it is worked out in limbs of eight digits.
+     */
+    constexpr std::size_t wholeDigits(char *out, std::uint64_t c, int q)
+    {
+        if (q <= 11)
+            return integer(out, c << q);
+
+        constexpr std::uint64_t e8 = 100000000;
+        std::uint64_t limbs[4] {c % e8, c / e8, 0, 0}; // Lowest first
+        std::uint64_t carry = 0;
+        for (auto& limb : limbs) {
+            limb = (limb << q) + carry;
+            carry = limb / e8;
+            limb %= e8;
+        }
+
+        int top = 3;
+        while (top > 0 && limbs[top] == 0)
+            top--;
+        auto size = leadingDigits(out, static_cast<std::uint32_t>(limbs[top]));
+        for (int i = top - 1; i >= 0; i--) {
+            storeDigits(out + size, eightDigits(static_cast<std::uint32_t>(limbs[i])), 8);
+            size += 8;
+        }
+        return size;
+    }
+
+    /**
+     * Computes g * cp / 2^127, rounded to odd, where g is one of
+     * powers::tens given as its high and low 63 bits.
+     */
+    constexpr std::uint64_t roundToOdd(std::uint64_t g1, std::uint64_t g0, std::uint64_t cp)
+    {
+        constexpr auto mask = ~std::uint64_t(0) >> 1;
+        const auto x1 = decimal::multiply(g0, cp).first;
+        const auto [y1, y0] = decimal::multiply(g1, cp);
+        const auto z = (y0 >> 1) + x1;
+        return (y1 + (z >> 63)) | (((z & mask) + mask) >> 63);
+    }
+
+    /**
+     * Finds the shortest decimal that rounds to c * 2^q, which is the
+     * closest such decimal if there are several (Schubfach).
+     * @param dk Added to the decimal's exponent
+     * @return A pair of the decimal's digits and exponent, which may have
+     *         trailing zeros
+     */
+    constexpr std::pair<std::uint64_t, int> schubfach(int q, std::uint64_t c, int dk)
+    {
+        // floor(log10(2^e)), floor(log10(3/4 * 2^e)) and floor(log2(10^e))
+        auto log10Pow2 = [](int e) {
+            return static_cast<int>((std::int64_t(e) * 661971961083) >> 41);
+        };
+        auto log10ThreeQuartersPow2 = [](int e) {
+            return static_cast<int>((std::int64_t(e) * 661971961083 - 274743187321) >> 41);
+        };
+        auto log2Pow10 = [](int e) {
+            return static_cast<int>((std::int64_t(e) * 913124641741) >> 38);
+        };
+
+        // The rounding interval of c is [cbl, cbr] in quarters, open if c is
+        // odd; it is narrower below powers of two
+        const std::uint64_t out = c & 1;
+        const auto cb = c << 2;
+        const auto cbr = cb + 2;
+        std::uint64_t cbl;
+        int k;
+        if (c != std::uint64_t(1) << 52 || q == -1074) {
+            cbl = cb - 2;
+            k = log10Pow2(q);
+        } else {
+            cbl = cb - 1;
+            k = log10ThreeQuartersPow2(q);
+        }
+        const int h = q + log2Pow10(-k) + 2;
+
+        // The interval scaled by 10^-k
+        const auto index = 2 * (-k - powers::tensSmallest);
+        const auto g1 = powers::tens[index];
+        const auto g0 = powers::tens[index + 1];
+        const auto vb = roundToOdd(g1, g0, cb << h);
+        const auto vbl = roundToOdd(g1, g0, cbl << h);
+        const auto vbr = roundToOdd(g1, g0, cbr << h);
+
+        // A decimal with one digit fewer, if exactly one lies within
+        const auto s = vb >> 2;
+        const auto sp10 = 10 * decimal::multiply(s, std::uint64_t(115292150460684698) << 4).first;
+        const auto tp10 = sp10 + 10;
+        const bool upin = vbl + out <= sp10 << 2;
+        const bool wpin = (tp10 << 2) + out <= vbr;
+        if (upin != wpin)
+            return {upin ? sp10 : tp10, k + dk};
+
+        // Otherwise, whichever of s and s + 1 lies within, or is closer
+        const auto t = s + 1;
+        const bool uin = vbl + out <= s << 2;
+        const bool win = (t << 2) + out <= vbr;
+        if (uin != win)
+            return {uin ? s : t, k + dk};
+
+        const auto cmp = static_cast<std::int64_t>(vb - ((s + t) << 1));
+        return {cmp < 0 || (cmp == 0 && (s & 1) == 0) ? s : t, k + dk};
+    }
+
+    /**
+     * Writes a finite double with the fewest digits that read back to the
+     * same value. Like std::to_chars(), plain or scientific notation is
+     * chosen by which is shorter, and whole numbers in plain notation are
+     * written with all of their digits rather than padded with zeros.
+     * @param out Where to write, with room for maxDouble characters
+     * @return The number of characters written
+     */
+    constexpr std::size_t shortest(char *out, double d)
+    {
+        const auto bits = std::bit_cast<std::uint64_t>(d);
+        const auto fraction = bits & ((std::uint64_t(1) << 52) - 1);
+        const auto biased = static_cast<int>(bits >> 52 & 0x7ff);
+
+        std::size_t size = 0;
+        if (bits >> 63)
+            out[size++] = '-';
+
+        std::pair<std::uint64_t, int> result {0, 0};
+        const auto c = fraction | std::uint64_t(1) << 52;
+        const int q = biased - 1075;
+        if (biased != 0) {
+            if (q < 0 && q > -53 && (c >> -q) << -q == c)
+                result = {c >> -q, 0}; // An integer
+            else
+                result = schubfach(q, c, 0);
+        } else if (fraction != 0) {
+            // Subnormal; the smallest need an extra digit of precision
+            result = fraction < 3 ? schubfach(-1074, 10 * fraction, -1)
+                                   : schubfach(-1074, fraction, 0);
+        } else {
+            out[size++] = '0';
+            return size;
+        }
+
+        auto [significand, exponent] = result;
+        while (significand % 10 == 0) {
+            significand /= 10;
+            exponent++;
+        }
+
+        char digits[maxInteger];
+        const auto length = integer(digits, significand);
+
+        const int n = static_cast<int>(length);
+        const int point = n + exponent; // Digits before the decimal point
+        const int scientific = point - 1;
+        const int scientificSize = n + (n > 1) + 2 + (scientific <= -100 || scientific >= 100 ? 3 : 2);
+        const int plainSize = exponent >= 0 ? n + exponent : point > 0 ? n + 1 : 2 - point + n;
+
+        if (plainSize <= scientificSize) {
+            if (biased != 0 && q >= 0) {
+                // Whole beyond 2^53: the shortest digits may differ
+                size += wholeDigits(out + size, c, q);
+            } else if (exponent >= 0) {
+                // Integer: digits, then zeros
+                for (int i = 0; i < n; i++)
+                    out[size++] = digits[i];
+                for (int i = 0; i < exponent; i++)
+                    out[size++] = '0';
+            } else if (point > 0) {
+                for (int i = 0; i < n; i++) {
+                    if (i == point)
+                        out[size++] = '.';
+                    out[size++] = digits[i];
+                }
+            } else {
+                out[size++] = '0';
+                out[size++] = '.';
+                for (int i = point; i < 0; i++)
+                    out[size++] = '0';
+                for (int i = 0; i < n; i++)
+                    out[size++] = digits[i];
+            }
+        } else {
+            out[size++] = digits[0];
+            if (n > 1) {
+                out[size++] = '.';
+                for (int i = 1; i < n; i++)
+                    out[size++] = digits[i];
+            }
+            out[size++] = 'e';
+            out[size++] = scientific < 0 ? '-' : '+';
+            const auto e = static_cast<unsigned>(scientific < 0 ? -scientific : scientific);
+            if (e >= 100)
+                out[size++] = static_cast<char>('0' + e / 100);
+            out[size++] = static_cast<char>('0' + e / 10 % 10);
+            out[size++] = static_cast<char>('0' + e % 10);
+        }
+
+        return size;
+    }
+}
+
+#endif // MINJSON_FORMAT_HPP_
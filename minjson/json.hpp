@@ -18,10 +18,28 @@
 #define JSON_HPP_
 
 #include "type.hpp"
+#include "arena.hpp"
+#include "charclass.hpp"
+#include "decimal.hpp"
+#include "escape.hpp"
+#include "format.hpp"
 #include "objectbase.hpp"
+#include "arrayindex.hpp"
 #include "arrayobject.hpp"
 #include "object.hpp"
+#include "paddedview.hpp"
 #include "parser.hpp"
+#include "structuralindex.hpp"
+#include "document.hpp"
+#include "keycache.hpp"
+#include "pointer.hpp"
+#include "fields.hpp"
+#include "staticindex.hpp"
+#include "visit.hpp"
+#include "walker.hpp"
+#include "cursor.hpp"
+#include "streamparser.hpp"
+#include "writer.hpp"
 
 #endif // JSON_HPP_
 
@@ -0,0 +1,141 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_KEYCACHE_HPP_
+#define MINJSON_KEYCACHE_HPP_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * A small open-addressed hash table mapping the keys of one JSON object
+     * to the offsets of their values. Used by parser::find() so that repeated
+     * lookups on the same object do not rescan it.
+     * @tparam N Number of slots; a power of two. At most 3/4 of the slots
+     *           are used, objects with more keys fall back to a linear search.
+     */
+    template<std::size_t N>
+    class keycache
+    {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+
+    public:
+        /**
+         * A cached key: its hash, and where its name and value begin.
+         */
+        struct entry
+        {
+            std::uint32_t hash = 0;
+            std::uint32_t name = 0;
+            std::uint32_t length = 0;
+            std::uint32_t value = 0;
+            bool used = false;
+        };
+
+    private:
+        std::array<entry, N> m_entries;
+        std::string_view m_body; // The object data that has been cached
+        std::size_t m_count;
+        bool m_overflow;
+
+    public:
+        constexpr keycache() : m_entries{}, m_count(0), m_overflow(false) {}
+
+        /**
+         * Hashes a key (FNV-1a).
+         */
+        constexpr static std::uint32_t hash(std::string_view key) {
+            std::uint32_t h = 2166136261u;
+            for (auto c : key) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        /**
+         * Tells if the cache holds the keys of the given object data.
+         */
+        constexpr bool holds(std::string_view body) const {
+            return m_body.data() == body.data() && m_body.size() == body.size();
+        }
+
+        /**
+         * Tells if the object had too many keys to be cached.
+         */
+        constexpr bool overflow() const {
+            return m_overflow;
+        }
+
+        /**
+         * Empties the cache, preparing it for the given object data.
+         */
+        constexpr void reset(std::string_view body) {
+            m_entries = {};
+            m_body = body;
+            m_count = 0;
+            m_overflow = false;
+        }
+
+        /**
+         * Adds a key, unless the key is already present.
+         * @param key The key's name, within the cached object data
+         * @param value Offset of the key's value within the object data
+         * @return False if the cache is full
+         */
+        constexpr bool insert(std::string_view key, std::size_t value) {
+            if (m_count >= N * 3 / 4) {
+                m_overflow = true;
+                return false;
+            }
+
+            const auto h = hash(key);
+            for (auto i = h & (N - 1); ; i = (i + 1) & (N - 1)) {
+                auto& e = m_entries[i];
+                if (!e.used) {
+                    e = {h, static_cast<std::uint32_t>(key.data() - m_body.data()),
+                         static_cast<std::uint32_t>(key.size()),
+                         static_cast<std::uint32_t>(value), true};
+                    m_count++;
+                    return true;
+                } else if (e.hash == h && m_body.substr(e.name, e.length) == key) {
+                    return true;
+                }
+            }
+        }
+
+        /**
+         * Looks up a key's entry, giving the offsets of its name and value
+         * within the object data.
+         */
+        constexpr std::optional<entry> lookup(std::string_view key) const {
+            const auto h = hash(key);
+            for (auto i = h & (N - 1); m_entries[i].used; i = (i + 1) & (N - 1)) {
+                const auto& e = m_entries[i];
+                if (e.hash == h && m_body.substr(e.name, e.length) == key)
+                    return e;
+            }
+
+            return {};
+        }
+    };
+}
+
+#endif // MINJSON_KEYCACHE_HPP_
@@ -0,0 +1,138 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_MAPPEDFILE_HPP_
+#define MINJSON_MAPPEDFILE_HPP_
+
+// POSIX only; not included by json.hpp.
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace minjson
+{
+    /**
+     * Maps a file into memory, read-only, so that its contents can be given
+     * to the parser without first being copied into a string. The kernel is
+     * advised that the mapping will be read sequentially and soon.
+     */
+    class mappedfile
+    {
+    private:
+        void *m_data;
+        std::size_t m_size;
+
+    public:
+        mappedfile() : m_data(nullptr), m_size(0) {}
+
+        explicit mappedfile(const char *path) : mappedfile() {
+            open(path);
+        }
+
+        mappedfile(const mappedfile&) = delete;
+        mappedfile& operator=(const mappedfile&) = delete;
+
+        mappedfile(mappedfile&& other) :
+            m_data(std::exchange(other.m_data, nullptr)),
+            m_size(std::exchange(other.m_size, 0)) {}
+
+        mappedfile& operator=(mappedfile&& other) {
+            if (this != &other) {
+                close();
+                m_data = std::exchange(other.m_data, nullptr);
+                m_size = std::exchange(other.m_size, 0);
+            }
+            return *this;
+        }
+
+        ~mappedfile() {
+            close();
+        }
+
+        /**
+         * Maps the given file, unmapping any previous one.
+         * @param path Path to the file
+         * @return True if the file was mapped; false if it could not be
+         *         opened or mapped, or is empty
+         */
+        bool open(const char *path) {
+            close();
+
+            int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return false;
+
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                auto size = static_cast<std::size_t>(st.st_size);
+                void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    m_data = data;
+                    m_size = size;
+                }
+            }
+
+            // The mapping remains valid once the descriptor is closed
+            ::close(fd);
+            if (m_data == nullptr)
+                return false;
+
+            // These are only hints; failures are harmless
+            madvise(m_data, m_size, MADV_SEQUENTIAL);
+            madvise(m_data, m_size, MADV_WILLNEED);
+#if defined(MADV_HUGEPAGE)
+            madvise(m_data, m_size, MADV_HUGEPAGE);
+#endif
+            return true;
+        }
+
+        /**
+         * Unmaps the file, if one is mapped.
+         */
+        void close() {
+            if (m_data != nullptr) {
+                munmap(m_data, m_size);
+                m_data = nullptr;
+                m_size = 0;
+            }
+        }
+
+        /**
+         * Tells if a file is mapped.
+         */
+        bool valid() const {
+            return m_data != nullptr;
+        }
+
+        /**
+         * Returns the file's contents, valid for as long as the file is mapped.
+         */
+        std::string_view view() const {
+            return {static_cast<const char *>(m_data), m_size};
+        }
+    };
+}
+
+#endif // defined(__unix__) || defined(__APPLE__)
+
+#endif // MINJSON_MAPPEDFILE_HPP_
@@ -0,0 +1,218 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_NDJSON_HPP_
+#define MINJSON_NDJSON_HPP_
+
+// Requires threads; not included by json.hpp.
+
+#include "parallel.hpp"
+#include "parser.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace minjson
+{
+    /**
+     * Reads newline-delimited JSON (JSON Lines), where each non-blank line
+     * holds one object. Records can be read one at a time with next(), or
+     * spread across threads with forEach() and transform().
+     */
+    class ndjson
+    {
+    private:
+        constexpr static auto npos = std::string_view::npos;
+
+        std::string_view m_data;
+        std::size_t m_index;
+        validation m_check;
+
+    public:
+        /**
+         * Amount of data handed to a thread at a time.
+         */
+        constexpr static std::size_t batchSize = 64 * 1024;
+
+        /**
+         * Selects whether transform() delivers results in record order.
+         */
+        enum class order
+        {
+            any,
+            preserved
+        };
+
+        /**
+         * @param data The NDJSON data
+         * @param check Validation of each record
+         */
+        constexpr ndjson(std::string_view data, validation check = validation::none) :
+            m_data(data), m_index(0), m_check(check) {}
+
+        /**
+         * Rewinds to the first record.
+         */
+        constexpr void rewind() {
+            m_index = 0;
+        }
+
+        /**
+         * Reads the next record.
+         * @return A parser started on the record, which is not ready() if the
+         *         record is not an object or fails validation; or nothing
+         *         after the last record
+         */
+        constexpr std::optional<parser> next() {
+            while (m_index < m_data.size()) {
+                auto line = lineAt(m_data, m_index);
+                m_index += line.size() + 1;
+                if (firstNonSpace(line) != npos) {
+                    parser p;
+                    p.start(line, m_check);
+                    return p;
+                }
+            }
+
+            return {};
+        }
+
+        /**
+         * Calls fn(parser&) for every record, from several threads at once.
+         * Records are not visited in any particular order.
+         * @param data The NDJSON data
+         * @param fn Function to call, which must be safe to call concurrently
+         * @param threads Number of threads, or zero for one per core
+         * @param check Validation of each record; failing records are skipped
+         */
+        template<typename F>
+        static void forEach(std::string_view data, F&& fn, unsigned threads = 0,
+                            validation check = validation::none)
+        {
+            const auto batches = (data.size() + batchSize - 1) / batchSize;
+            std::atomic_size_t nextBatch = 0;
+
+            parallel::run(threads, [&](unsigned) {
+                for (auto b = nextBatch++; b < batches; b = nextBatch++)
+                    forBatch(data, b, check, fn);
+            });
+        }
+
+        /**
+         * Calls fn(parser&) for every record from several threads at once,
+         * passing each result to sink. Calls to sink are never concurrent.
+         * @param data The NDJSON data
+         * @param fn Function to call, which must be safe to call concurrently
+         * @param sink Receives each result
+         * @param o Whether results must reach sink in record order
+         * @param threads Number of threads, or zero for one per core
+         * @param check Validation of each record; failing records are skipped
+         */
+        template<typename F, typename S>
+        static void transform(std::string_view data, F&& fn, S&& sink,
+                              order o = order::preserved, unsigned threads = 0,
+                              validation check = validation::none)
+        {
+            using result = std::invoke_result_t<F&, parser&>;
+
+            const auto batches = (data.size() + batchSize - 1) / batchSize;
+            std::atomic_size_t nextBatch = 0;
+
+            // Finished batches waiting on earlier ones, when order matters
+            std::mutex lock;
+            std::vector<std::vector<result>> pending (o == order::preserved ? batches : 0);
+            std::vector<bool> finished (pending.size());
+            std::size_t delivered = 0;
+
+            parallel::run(threads, [&](unsigned) {
+                std::vector<result> results;
+                for (auto b = nextBatch++; b < batches; b = nextBatch++) {
+                    forBatch(data, b, check, [&](parser& p) { results.push_back(fn(p)); });
+
+                    std::scoped_lock guard (lock);
+                    if (o == order::any) {
+                        for (auto& r : results)
+                            sink(std::move(r));
+                        results.clear();
+                        continue;
+                    }
+
+                    pending[b] = std::move(results);
+                    results = {};
+                    finished[b] = true;
+                    for (; delivered < batches && finished[delivered]; delivered++) {
+                        for (auto& r : pending[delivered])
+                            sink(std::move(r));
+                        pending[delivered] = {};
+                    }
+                }
+            });
+        }
+
+    private:
+        /**
+         * Returns the line beginning at the given index, without its newline.
+         */
+        constexpr static std::string_view lineAt(std::string_view data, std::size_t index) {
+            auto end = simd::find(data, '\n', index);
+            return data.substr(index, end == npos ? npos : end - index);
+        }
+
+        /**
+         * Calls fn for each record that begins within the given batch.
+         */
+        template<typename F>
+        constexpr static void forBatch(std::string_view data, std::size_t batch,
+                                       validation check, F&& fn)
+        {
+            auto index = batch * batchSize;
+            const auto end = std::min(index + batchSize, data.size());
+
+            // Skip the record that began in the previous batch
+            if (index > 0) {
+                index = simd::find(data, '\n', index - 1);
+                if (index == npos)
+                    return;
+                index++;
+            }
+
+            while (index < end) {
+                auto line = lineAt(data, index);
+                index += line.size() + 1;
+                if (firstNonSpace(line) == npos)
+                    continue;
+
+                simd::utf8state utf8;
+                if (check == validation::utf8)
+                    simd::validateUtf8(line.data(), line.size(), utf8);
+                if (utf8.valid()) {
+                    parser p;
+                    p.start(line);
+                    fn(p);
+                }
+            }
+        }
+    };
+}
+
+#endif // MINJSON_NDJSON_HPP_
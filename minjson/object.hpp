@@ -35,8 +35,11 @@ namespace minjson
     public:
         constexpr object(std::string_view name = {},
                          minjson::type type = minjson::type::null,
-                         std::string_view value = {}) :
-            objectbase(type, value), m_name(name) {}
+                         std::string_view value = {},
+                         const structuralindex *structure = nullptr,
+                         minjson::numberkind kind = minjson::numberkind::floating,
+                         bool padded = false) :
+            objectbase(type, value, structure, kind, padded), m_name(name) {}
 
         constexpr std::string_view name() const {
             return m_name;
@@ -17,10 +17,17 @@
 #ifndef MINJSON_OBJECTBASE_HPP_
 #define MINJSON_OBJECTBASE_HPP_
 
+#include "arena.hpp"
+#include "decimal.hpp"
+#include "escape.hpp"
+#include "simd.hpp"
 #include "type.hpp"
 
-#include <cctype>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <optional>
+#include <span>
 #include <string_view>
 #include <type_traits>
 
@@ -35,6 +42,7 @@ namespace minjson
 
     class parser;
     class arrayobject;
+    class structuralindex;
 
     /**
      * Defines the base for a JSON object, specifying the object's type and value as a string.
@@ -43,74 +51,157 @@ namespace minjson
     {
     protected:
         minjson::type m_type;
+        minjson::numberkind m_kind; // Range of a number, found by the parser
         std::string_view m_value;
+        const structuralindex *m_structure; // Index of the data, if available
+        bool m_padded; // Set if the data lies within a paddedview
 
     public:
         constexpr objectbase(minjson::type type = minjson::type::null,
-                             std::string_view value = {}) :
-            m_type(type), m_value(value) {}
+                             std::string_view value = {},
+                             const structuralindex *structure = nullptr,
+                             minjson::numberkind kind = minjson::numberkind::floating,
+                             bool padded = false) :
+            m_type(type), m_kind(kind), m_value(value), m_structure(structure),
+            m_padded(padded) {}
 
         constexpr minjson::type type() const {
             return m_type;
         }
 
         /**
-         * Default get() for reading the object's data. Returns nothing.
+         * Returns the range of the object's number, if it is a number.
+         * Objects not made by the parser are assumed to be floating.
+         */
+        constexpr minjson::numberkind numberkind() const {
+            return m_kind;
+        }
+
+        /**
+         * Returns the object's value as it appears in the JSON data.
+         */
+        constexpr std::string_view raw() const {
+            return m_value;
+        }
+
+        /**
+         * Returns the structural index of the JSON data, if there is one.
+         */
+        constexpr const structuralindex *structure() const {
+            return m_structure;
+        }
+
+        /**
+         * Tells if the JSON data lies within a paddedview.
+         */
+        constexpr bool padded() const {
+            return m_padded;
+        }
+
+        /**
+         * get() for non-numeric data. Strings (std::string_view) have their
+         * surrounding quotes trimmed off; booleans are read as bool. Returns
+         * nothing for any other type.
          */
         template<typename T>
         constexpr std::optional<std::enable_if_t<!numeric<T>, T>> get() const {
+            if constexpr (std::is_same_v<T, std::string_view>) {
+                if (m_type == type::string)
+                    return m_value.substr(1, m_value.size() - 2);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                if (m_type == type::boolean)
+                    return m_value == "true";
+            }
+
             return {};
         }
 
         /**
          * get() for number data, accepting both integers and floating-points.
+         * Floating-points are correctly rounded; integers take the integer
+         * part of the number, or nothing if it does not fit in T.
          */
         template<typename T>
         constexpr std::optional<std::enable_if_t<numeric<T>, T>> get() const {
-            if (m_type != type::number)
+            if (m_type != type::number || m_value.empty())
                 return {};
 
-            T n = 0;
-            bool decimal = false;
-            int decimalCount = 0;
-            for (auto c : m_value) {
-                if (isdigit(c)) {
-                    n = n * 10 + (c - '0');
-                    if (decimal)
-                        decimalCount++;
-                } else if (c == '.') {
-                    if (std::is_floating_point_v<T>)
-                        decimal = true;
-                    else
-                        break; // Better than failing
+            if constexpr (std::is_integral_v<T>) {
+                if (m_kind != minjson::numberkind::floating) {
+                    // Plain digits that are known to fit in 64 bits
+                    const bool negative = m_value[0] == '-';
+                    std::uint64_t n = 0;
+                    for (auto c : m_value.substr(negative))
+                        n = n * 10 + static_cast<unsigned>(c - '0');
+                    return integral<T>(n, negative);
                 }
             }
 
-            for (; decimalCount > 0; decimalCount--)
-                n /= 10;
-            return n;
+            auto d = decimal::parse(m_value);
+            if (!d)
+                return {};
+
+            if constexpr (std::is_floating_point_v<T>) {
+                return d->template toFloat<T>();
+            } else {
+                auto n = d->mantissa;
+                for (auto e = d->exponent; e > 0 && n > 0; e--) {
+                    if (n > std::numeric_limits<std::uint64_t>::max() / 10)
+                        return {};
+                    n *= 10;
+                }
+                for (auto e = d->exponent; e < 0 && n > 0; e++)
+                    n /= 10;
+                return integral<T>(n, d->negative);
+            }
         }
 
         /**
-         *  get() for string data. Trims off the quotes surrounding the string.
+         * Gets string data with its escape sequences replaced. If the string
+         * has none, its data is returned as-is and out is left untouched.
+         * @param out Storage for the unescaped string
+         * @return The string, or nothing if this is not a string, an escape is
+         *         invalid, or out is too small
          */
-        template<>
-        constexpr std::optional<std::string_view> get<std::string_view>() const {
-            if (m_type == type::string)
-                return m_value.substr(1, m_value.size() - 2);
+        constexpr std::optional<std::string_view> getUnescaped(std::span<char> out) const {
+            auto str = get<std::string_view>();
+            if (!str)
+                return {};
+
+            auto first = simd::find(*str, '\\');
+            if (first == std::string_view::npos)
+                return str;
+            else if (first > out.size())
+                return {};
+
+            std::copy_n(str->data(), first, out.data());
+            if (auto size = unescape(str->substr(first), out.subspan(first)); size)
+                return std::string_view(out.data(), first + *size);
             else
                 return {};
         }
 
         /**
-         * get() for bool data.
+         * Gets string data with its escape sequences replaced, taking storage
+         * from the given arena only if the string has escapes.
+         * @param storage Arena to hold the unescaped string
+         * @return The string, or nothing if this is not a string, an escape is
+         *         invalid, or the arena is out of space
          */
-        template<>
-        constexpr std::optional<bool> get<bool>() const {
-            if (m_type == type::boolean)
-               return m_value == "true";
-            else
+        constexpr std::optional<std::string_view> getUnescaped(arena& storage) const {
+            if (m_type != type::string)
                 return {};
+            if (simd::find(m_value, '\\') == std::string_view::npos)
+                return get<std::string_view>();
+
+            // The result is never longer than the escaped string
+            auto out = storage.allocate(m_value.size() - 2);
+            if (!out)
+                return {};
+
+            auto str = getUnescaped(*out);
+            storage.shrink(*out, str ? str->size() : 0);
+            return str;
         }
 
         /**
@@ -124,6 +215,29 @@ namespace minjson
          * should this object be an array.
          */
         constexpr std::optional<arrayobject> getArrayFirst() const;
+
+    private:
+        /**
+         * Converts the given magnitude and sign to T, if it fits.
+         */
+        template<typename T>
+        constexpr static std::optional<T> integral(std::uint64_t n, bool negative) {
+            constexpr auto max = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+
+            if (negative) {
+                if constexpr (std::is_unsigned_v<T>) {
+                    if (n != 0)
+                        return {};
+                } else if (n > max + 1) {
+                    return {};
+                }
+                return static_cast<T>(0 - n);
+            } else if (n > max) {
+                return {};
+            }
+
+            return static_cast<T>(n);
+        }
     };
 }
 
@@ -136,7 +250,8 @@ namespace minjson
     {
         if (m_type == type::object) {
             parser p;
-            p.start(m_value);
+            p.start(m_value, m_structure);
+            p.m_padded = m_padded;
             return p;
         } else {
             return {};
@@ -146,7 +261,7 @@ namespace minjson
     constexpr std::optional<arrayobject> objectbase::getArrayFirst() const
     {
         if (m_type == type::array)
-            return arrayobject(m_value.substr(1));
+            return arrayobject(m_value.substr(1), m_structure, m_padded);
         else
             return {};
     }
@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_PADDEDVIEW_HPP_
+#define MINJSON_PADDEDVIEW_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * A view of JSON data that is followed in memory by at least 'padding'
+     * zero bytes. Parsers started with one may read past the end of a value
+     * without testing for it on every byte: the padding stops any scan, and
+     * results are checked against the end once.
+     */
+    class paddedview
+    {
+    private:
+        std::string_view m_data;
+
+        constexpr paddedview(std::string_view data) : m_data(data) {}
+
+    public:
+        /**
+         * The number of zero bytes required after the data; enough for one
+         * block of simd::classify().
+         */
+        constexpr static std::size_t padding = 64;
+
+        /**
+         * Gives the size of the storage needed to copy data of the given
+         * length.
+         */
+        constexpr static std::size_t storageSize(std::size_t length) {
+            return length + padding;
+        }
+
+        /**
+         * Copies the given data into storage and pads it.
+         * @param data The JSON data
+         * @param storage Storage of at least storageSize() bytes
+         * @return A view of the copy, or nothing if storage is too small
+         */
+        constexpr static std::optional<paddedview> copy(std::string_view data,
+                                                        std::span<char> storage)
+        {
+            if (data.size() > storage.size() || storage.size() - data.size() < padding)
+                return {};
+
+            auto end = std::copy(data.begin(), data.end(), storage.begin());
+            std::fill_n(end, padding, '\0');
+            return paddedview(std::string_view(storage.data(), data.size()));
+        }
+
+        /**
+         * Uses data that is already padded, such as a buffer read from a file
+         * with room left at its end.
+         * @param buffer The data and its padding
+         * @param length The length of the data
+         * @return A view of the data, or nothing if the buffer is not padded
+         */
+        constexpr static std::optional<paddedview> adopt(std::span<const char> buffer,
+                                                         std::size_t length)
+        {
+            if (length > buffer.size() || buffer.size() - length < padding)
+                return {};
+
+            auto pad = buffer.subspan(length, padding);
+            if (std::any_of(pad.begin(), pad.end(), [](char c) { return c != '\0'; }))
+                return {};
+
+            return paddedview(std::string_view(buffer.data(), length));
+        }
+
+        /**
+         * Returns the data, without its padding.
+         */
+        constexpr std::string_view view() const {
+            return m_data;
+        }
+
+        constexpr std::size_t size() const {
+            return m_data.size();
+        }
+    };
+}
+
+#endif // MINJSON_PADDEDVIEW_HPP_
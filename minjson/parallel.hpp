@@ -0,0 +1,160 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_PARALLEL_HPP_
+#define MINJSON_PARALLEL_HPP_
+
+// Requires threads; not included by json.hpp.
+
+#include "arrayobject.hpp"
+#include "objectbase.hpp"
+#include "simd.hpp"
+#include "structuralindex.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace minjson::parallel
+{
+    /**
+     * Gives the number of threads to use when zero is requested.
+     */
+    inline unsigned threadCount(unsigned threads = 0)
+    {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        return threads > 0 ? threads : 1;
+    }
+
+    /**
+     * Runs the given worker on the given number of threads, including the
+     * calling thread, and waits for all of them to return.
+     * @param threads Number of threads, or zero for one per core
+     * @param worker Called as worker(n) for thread n
+     */
+    template<typename F>
+    void run(unsigned threads, F&& worker)
+    {
+        threads = threadCount(threads);
+
+        std::vector<std::jthread> pool;
+        pool.reserve(threads - 1);
+        for (unsigned n = 1; n < threads; n++)
+            pool.emplace_back([&worker, n] { worker(n); });
+
+        worker(0u);
+    }
+
+    /**
+     * Number of array entries handed to a thread at a time.
+     */
+    constexpr std::size_t grainSize = 256;
+
+    /**
+     * Finds where every grainSize'th entry of an array begins, relative to
+     * the first character after the '['. Uses the array's structural index to
+     * jump between depth-one commas if it has one, otherwise finds those
+     * commas a block at a time.
+     */
+    inline std::vector<std::size_t> partition(const objectbase& array)
+    {
+        const auto whole = array.raw().substr(1);
+        std::vector<std::size_t> starts {0};
+        std::size_t count = 0;
+
+        if (auto index = array.structure(); index && index->offsetOf(whole) != index->npos) {
+            const auto base = index->offsetOf(whole);
+            const auto json = index->json();
+            for (auto pos = index->next(base); pos != index->npos;) {
+                const char c = json[pos];
+                if (c == '{' || c == '[') {
+                    pos = index->closing(pos);
+                    pos = pos != index->npos ? index->next(pos + 1) : pos;
+                } else if (c == '\"') {
+                    pos = index->next(pos + 1);
+                    pos = pos != index->npos ? index->next(pos + 1) : pos;
+                } else if (c == ',') {
+                    if (++count % grainSize == 0)
+                        starts.push_back(pos + 1 - base);
+                    pos = index->next(pos + 1);
+                } else {
+                    break;
+                }
+            }
+        } else {
+            // Depth-one commas, found from block masks as arrayobject::count()
+            // does, so that no entry has its type determined
+            simd::stringstate state;
+            int depth = 0;
+            for (std::size_t from = 0; from < whole.size(); from += simd::blocksize) {
+                const auto m = simd::classify(whole.data() + from,
+                    std::min(simd::blocksize, whole.size() - from));
+                const auto outside = ~simd::stringMasks(m, state).second;
+                for (auto bits = (m.comma | m.open | m.close) & outside; bits != 0;
+                     bits &= bits - 1)
+                {
+                    const auto bit = bits & (~bits + 1);
+                    if ((m.open & bit) != 0) {
+                        depth++;
+                    } else if ((m.close & bit) != 0) {
+                        if (--depth < 0)
+                            return starts;
+                    } else if (depth == 0 && ++count % grainSize == 0) {
+                        starts.push_back(from + std::countr_zero(bits) + 1);
+                    }
+                }
+            }
+        }
+
+        return starts;
+    }
+
+    /**
+     * Calls fn(const objectbase&) for every entry of an array, from several
+     * threads at once. Entries are split into ranges of grainSize, which the
+     * threads claim in turn; entries are not visited in any particular order.
+     * @param array The array
+     * @param fn Function to call, which must be safe to call concurrently
+     * @param threads Number of threads, or zero for one per core
+     * @return False if the given object is not an array
+     */
+    template<typename F>
+    bool forEach(const objectbase& array, F&& fn, unsigned threads = 0)
+    {
+        if (array.type() != type::array)
+            return false;
+
+        const auto whole = array.raw().substr(1);
+        const auto starts = partition(array);
+        std::atomic_size_t nextRange = 0;
+
+        run(threads, [&](unsigned) {
+            for (auto r = nextRange++; r < starts.size(); r = nextRange++) {
+                arrayobject entry (whole.substr(starts[r]), array.structure(), array.padded());
+                for (std::size_t i = 0; i < grainSize && entry.valid(); i++, entry.next())
+                    fn(static_cast<const objectbase&>(entry));
+            }
+        });
+
+        return true;
+    }
+}
+
+#endif // MINJSON_PARALLEL_HPP_
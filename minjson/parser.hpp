@@ -18,9 +18,16 @@
 #define MINJSON_PARSER_HPP_
 
 #include "type.hpp"
+#include "charclass.hpp"
 #include "object.hpp"
+#include "paddedview.hpp"
+#include "keycache.hpp"
+#include "structuralindex.hpp"
 
-#include <cctype>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
 #include <optional>
 #include <string_view>
 #include <tuple>
@@ -36,21 +43,47 @@ namespace minjson
         bool m_ready; // Set 'true' if data is available
         std::size_t m_index; // Index within the JSON data
         std::string_view m_body; // Contains the 'body' of the JSON data
+        const structuralindex *m_structure; // Index of the JSON data, if any
+        bool m_padded; // Set if the data lies within a paddedview
 
         constexpr static auto npos = std::string_view::npos;
+
+        friend class objectbase;
+        friend class cursor;
     
     public:
-        constexpr parser() : m_ready(false), m_index(0) {}
+        constexpr parser() :
+            m_ready(false), m_index(0), m_structure(nullptr), m_padded(false) {}
     
         /**
          * Starts the parser with a given string of JSON data.
          * @param jstr String containing JSON data
+         * @param structure Optional structural index containing jstr
+         * @param check Validation of the data; skipped if the structural index
+         *              has already done it
          * @return True if ready and able to parse the data
          */
-        constexpr bool start(std::string_view jstr) {
-            auto from = jstr.find_first_not_of(" \t\r\n");
+        constexpr bool start(std::string_view jstr,
+                             const structuralindex *structure = nullptr,
+                             validation check = validation::none)
+        {
+            if (structure && structure->offsetOf(jstr) == npos)
+                structure = nullptr;
+            m_structure = structure;
+            m_padded = false;
+
+            if (check == validation::utf8 && !(structure && structure->utf8())) {
+                simd::utf8state utf8;
+                simd::validateUtf8(jstr.data(), jstr.size(), utf8);
+                if (!utf8.valid()) {
+                    m_ready = false;
+                    return false;
+                }
+            }
+
+            auto from = firstNonSpace(jstr);
             if (from != npos && jstr[from] == '{') {
-                auto to = jstr.find_last_not_of(" \t\r\n");
+                auto to = lastNonSpace(jstr);
 
                 m_ready = to != npos && jstr[to] == '}';
                 if (m_ready) {
@@ -63,6 +96,38 @@ namespace minjson
     
             return m_ready;
         }
+
+        /**
+         * Starts the parser with a given string of JSON data.
+         * @param jstr String containing JSON data
+         * @param check Validation of the data
+         * @return True if ready and able to parse the data
+         */
+        constexpr bool start(std::string_view jstr, validation check) {
+            return start(jstr, nullptr, check);
+        }
+
+        /**
+         * Starts the parser with padded JSON data. Values are then scanned
+         * without testing for the end of the data on every byte.
+         * @param data The padded JSON data
+         * @param check Validation of the data
+         * @return True if ready and able to parse the data
+         */
+        constexpr bool start(const paddedview& data, validation check = validation::none) {
+            start(data.view(), nullptr, check);
+            m_padded = true;
+            return m_ready;
+        }
+
+        /**
+         * Starts the parser with the data of the given structural index.
+         * @param structure Structural index of the JSON data
+         * @return True if ready and able to parse the data
+         */
+        constexpr bool start(const structuralindex& structure) {
+            return start(structure.json(), &structure);
+        }
         
         /**
          * Tells if the parser is 'ready'; that is, data is available.
@@ -71,6 +136,13 @@ namespace minjson
             return m_ready;
         }
 
+        /**
+         * Tells if the object the parser was started on has no members.
+         */
+        constexpr bool empty() const {
+            return firstNonSpace(m_body) == npos;
+        }
+
         /**
          * Rewinds the parser to the beginning of the last given JSON data.
          */
@@ -84,130 +156,418 @@ namespace minjson
          * @return The next object, or nothing on error
          */
         constexpr std::optional<object> next() {
-            if (!m_ready)
-                return {};
+            return m_padded ? read<true>() : read<false>();
+        }
 
-            // Search for the name field (key of the key-value pair)
-            if (auto nameStart = m_body.find('\"', m_index); nameStart != npos) {
-                if (auto nameEnd = m_body.find('\"', nameStart + 1);
-                    nameEnd != npos && nameEnd > nameStart)
-                {
-                    // Name found; next, find the value
-                    if (auto valueStart = m_body.find(':', nameEnd + 1);
-                        valueStart != npos)
+        /**
+         * Searches the JSON data for the object with the given name. The
+         * position of next() is not affected.
+         * @param key Name of the object to find
+         * @return The first object with that name, or nothing if not found
+         */
+        constexpr std::optional<object> find(std::string_view key) const {
+            parser p = *this;
+            for (p.rewind(); p.ready();) {
+                auto o = p.next();
+                if (!o)
+                    break;
+                else if (o->name() == key)
+                    return o;
+            }
+
+            return {};
+        }
+
+        /**
+         * Searches the JSON data for the object with the given name, using the
+         * given cache. The first search fills the cache with every key in the
+         * data; later searches through the same cache do not rescan the data.
+         * @param key Name of the object to find
+         * @param cache Cache for this parser's data
+         * @return The first object with that name, or nothing if not found
+         */
+        template<std::size_t N>
+        constexpr std::optional<object> find(std::string_view key,
+                                             keycache<N>& cache) const
+        {
+            if (!cache.holds(m_body)) {
+                cache.reset(m_body);
+                parser p = *this;
+                for (p.rewind(); p.ready();) {
+                    auto o = p.next();
+                    if (!o || !cache.insert(o->name(),
+                            static_cast<std::size_t>(o->raw().data() - m_body.data())))
                     {
-                        // Construct the object
-                        auto pair = determineType(m_body.substr(valueStart + 1));
-                        if (!pair)
-                            return {};
-                        object o {
-                            m_body.substr(nameStart + 1, nameEnd - nameStart - 1),
-                            pair->first,
-                            m_body.substr(valueStart + 2, pair->second - 1)
-                        };
-
-                        // Advance index to next object, or ready = false if
-                        // this is the end.
-                        m_index = m_body.find_first_not_of(" \t\n\r", valueStart + 1 + pair->second);
-                        if (m_index == npos || m_body[m_index] != ',')
-                            m_ready = false;
-
-                        return o;
+                        break;
                     }
                 }
             }
 
+            if (cache.overflow())
+                return find(key);
+
+            if (auto entry = cache.lookup(key); entry) {
+                auto val = m_body.substr(entry->value);
+                auto kind = numberkind::floating;
+                auto pair = m_padded ? determineType<true>(val, m_structure, &kind)
+                                     : determineType(val, m_structure, &kind);
+                if (pair) {
+                    return object {
+                        m_body.substr(entry->name, entry->length),
+                        pair->first,
+                        val.substr(0, pair->second),
+                        m_structure,
+                        kind,
+                        m_padded
+                    };
+                }
+            }
+
             return {};
         }
 
         /**
          * Attempts to determine the type of the given JSON value data.
          * @param val Value string to analyze
+         * @param structure Optional structural index containing val
+         * @param kind If given, set to the range of the value should it be a
+         *             number
+         * @tparam Padded If true, val must lie within a paddedview
          * @return A pair of the type and data's size, or nothing on error
          */
+        template<bool Padded = false>
         constexpr static std::optional<std::pair<type, std::size_t>>
-            determineType(std::string_view val)
+            determineType(std::string_view val,
+                          const structuralindex *structure = nullptr,
+                          numberkind *kind = nullptr)
         {
-            std::pair<type, std::size_t> result;
+            const auto valueStart = firstNonSpace<Padded>(val);
+            if (valueStart == npos)
+                return std::pair<type, std::size_t> {};
 
-            if (auto valueStart = val.find_first_not_of(" \t\r\n");
-                valueStart != npos)
+            // Dispatch on the class of the value's first character
+            const auto base = structure ? structure->offsetOf(val) : npos;
+            const auto cls = classOf(val[valueStart]);
+            switch (cls) {
+            case charclass::quote:
             {
-                char c = val[valueStart];
+                // String: find the terminating quote, which is the next
+                // structural character if there is an index
+                auto end = npos;
+                if (base != npos) {
+                    end = structure->next(base + valueStart + 1);
+                    end = end != npos && end - base < val.size() ? end - base : npos;
+                } else {
+                    end = stringEnd<Padded>(val, valueStart + 1);
+                }
 
-                if (c == '\"') {
-                    // Should be a string: find the terminating quote
-                    for (valueStart++; valueStart < val.size(); valueStart++) {
-                        if (val[valueStart] == '\"' && val[valueStart - 1] != '\\')
-                            break;
-                    }
+                if (end == npos)
+                    return {};
+                return std::pair {type::string, end + 1};
+            }
+            case charclass::object:
+            case charclass::array:
+            {
+                // Object or array: find (or jump to) the closing bracket
+                const auto t = cls == charclass::object ? type::object : type::array;
+                auto end = npos;
+                if (base != npos) {
+                    end = structure->closing(base + valueStart);
+                    end = end != npos && end - base < val.size() ? end - base : npos;
+                } else {
+                    end = closingBracket<Padded>(val, valueStart);
+                    if (end != npos && val[end] != (t == type::object ? '}' : ']'))
+                        end = npos;
+                }
 
-                    if (valueStart >= val.size())
-                        return {};
+                if (end == npos)
+                    return {};
+                return std::pair {t, end + 1};
+            }
+            case charclass::zero:
+            case charclass::digit:
+            case charclass::minus:
+            {
+                // Number: scan to its end
+                auto number = scanNumber<Padded>(val.substr(valueStart));
+                if (!number)
+                    return {};
 
-                    result = {type::string, valueStart + 1};
-                } else if (isdigit(c) || c == '-' || c == '.') {
-                    // Number: find end of number
-                    while (isdigit(val[++valueStart]) || val[valueStart] == '.');
-                    result = {type::number, valueStart};
-                } else if (c == '{') {
-                    // Object: Find end of object
-                    valueStart++;
-                    int nestCount = 0;
-                    bool quote = false;
-                    for (; valueStart < val.size() && nestCount >= 0; valueStart++) {
-                        if (val[valueStart] == '\"' && val[valueStart - 1] != '\\') {
-                            // Enter or exit from quotation
-                            quote ^= true;
-                        } else if (!quote) {
-                            // Change nestCount if entering/exiting layer of {}
-                            if (val[valueStart] == '{')
-                                nestCount++;
-                            else if (val[valueStart] == '}')
-                                nestCount--;
-                        }
-                    }
+                if (kind)
+                    *kind = number->first;
+                return std::pair {type::number, valueStart + number->second};
+            }
+            case charclass::literal:
+                // Boolean or null
+                if (val.compare(valueStart, 4, "true") == 0)
+                    return std::pair {type::boolean, valueStart + 4};
+                else if (val.compare(valueStart, 5, "false") == 0)
+                    return std::pair {type::boolean, valueStart + 5};
+                else if (val.compare(valueStart, 4, "null") == 0)
+                    return std::pair {type::null, valueStart + 4};
+                else
+                    return {};
+            default:
+                return {};
+            }
+        }
 
-                    // Object opened with nestCount = 0; nestCount will become
-                    // -1 if the object's {} is closed before the file's end.
-                    if (nestCount != -1)
-                        return {};
+        /**
+         * Scans the number at the start of the given string, following the
+         * JSON grammar. Integers are accumulated during the scan to find
+         * which range they fall within.
+         * @param val String beginning with a number
+         * @tparam Padded If true, val must lie within a paddedview; the scan
+         *                then runs to the first non-number character without
+         *                testing for the end of val
+         * @return A pair of the number's range and size, or nothing if it is
+         *         not a valid number
+         */
+        template<bool Padded = false>
+        constexpr static std::optional<std::pair<numberkind, std::size_t>>
+            scanNumber(std::string_view val)
+        {
+            // States, with those from 'done' on ending the scan
+            enum : std::uint8_t { start, sign, leading, integer, point, fraction,
+                                  e, esign, exponent, done, error };
 
-                    result = {type::object, valueStart};
-                } else if (c == '[') {
-                    // Array: find the end
-                    valueStart++;
-                    int nestCount = 0;
-                    bool quote = false;
-                    for (; valueStart < val.size() && nestCount >= 0; valueStart++) {
-                        if (val[valueStart] == '\"' && val[valueStart - 1] != '\\') {
-                            quote ^= true;
-                        } else if (!quote) {
-                            if (val[valueStart] == '[')
-                                nestCount++;
-                            else if (val[valueStart] == ']')
-                                nestCount--;
-                        }
-                    }
+            // Indexed by state, then by the class of the next character
+            constexpr std::uint8_t transitions[9][7] = {
+                //    other  zero      digit     minus  plus   dot    exponent
+                /* start    */ { error, leading,  integer,  sign,  error, error, error },
+                /* sign     */ { error, leading,  integer,  error, error, error, error },
+                /* leading  */ { done,  error,    error,    done,  done,  point, e     },
+                /* integer  */ { done,  integer,  integer,  done,  done,  point, e     },
+                /* point    */ { error, fraction, fraction, error, error, error, error },
+                /* fraction */ { done,  fraction, fraction, done,  done,  done,  e     },
+                /* e        */ { error, exponent, exponent, esign, esign, error, error },
+                /* esign    */ { error, exponent, exponent, error, error, error, error },
+                /* exponent */ { done,  exponent, exponent, done,  done,  done,  done  }
+            };
 
-                    if (nestCount != -1)
+            constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+            std::uint64_t value = 0;
+            bool overflow = false;
+            bool integral = true;
+
+            std::uint8_t state = start;
+            std::size_t i = 0;
+            for (;; i++) {
+                // The end of the string, and classes found outside of
+                // numbers, act as 'other'
+                auto cls = charclass::other;
+                if constexpr (Padded) {
+                    if (classOf(val.data()[i]) <= charclass::exponent)
+                        cls = classOf(val.data()[i]);
+                } else if (i < val.size() && classOf(val[i]) <= charclass::exponent) {
+                    cls = classOf(val[i]);
+                }
+                const auto next = transitions[state][static_cast<std::uint8_t>(cls)];
+                if (next >= done) {
+                    if (next == error)
                         return {};
+                    break;
+                }
+
+                if (next == integer) {
+                    const unsigned d = static_cast<unsigned>(val[i] - '0');
+                    overflow |= value > (max - d) / 10;
+                    value = value * 10 + d;
+                } else if (next == point || next == e) {
+                    integral = false;
+                }
+                state = next;
+            }
+
+            // A number running past the end of val (as it may if val is part
+            // of a larger value) is scanned again within bounds
+            if constexpr (Padded) {
+                if (i > val.size())
+                    return scanNumber<false>(val);
+            }
 
-                    result = {type::array, valueStart};
+            auto kind = numberkind::floating;
+            if (integral && !overflow) {
+                constexpr auto maxSigned = static_cast<std::uint64_t>(
+                    std::numeric_limits<std::int64_t>::max());
+                if (val[0] == '-') {
+                    if (value <= maxSigned + 1)
+                        kind = numberkind::int64;
                 } else {
-                    // Object is either boolean, null, or invalid JSON
-                    if (val.compare(valueStart, 4, "true") == 0)
-                        result = {type::boolean, valueStart + 4};
-                    else if (val.compare(valueStart, 5, "false") == 0)
-                        result = {type::boolean, valueStart + 5};
-                    else if (val.compare(valueStart, 4, "null") == 0)
-                        result = {type::null, valueStart + 4};
-                    else
-                        return {};
+                    kind = value <= maxSigned ? numberkind::int64 : numberkind::uint64;
+                }
+            }
+
+            return std::pair {kind, i};
+        }
+
+        /**
+         * Passes over the value at the given index without determining its
+         * type: objects and arrays are passed by counting brackets (or
+         * through the structural index), strings by finding their closing
+         * quote, and anything else by finding the next comma.
+         * @param val String holding the value
+         * @param from Index of the value's first character
+         * @param structure Optional structural index containing val
+         * @return Index of the comma following the value, or npos if there
+         *         is none
+         */
+        constexpr static std::size_t skipValue(std::string_view val, std::size_t from,
+                                               const structuralindex *structure = nullptr)
+        {
+            const auto base = structure ? structure->offsetOf(val) : npos;
+            auto end = npos;
+            if (base != npos) {
+                // Jump between structural characters, over the value's own
+                // if it has any
+                auto pos = structure->next(base + from);
+                if (pos == base + from) {
+                    const char c = val[from];
+                    if (c == '{' || c == '[')
+                        pos = structure->closing(pos);
+                    else if (c == '\"')
+                        pos = structure->next(pos + 1);
+                    pos = pos != npos ? structure->next(pos + 1) : npos;
+                }
+                end = pos != npos && pos - base < val.size() ? pos - base : npos;
+            } else {
+                switch (val[from]) {
+                case '{':
+                case '[':
+                    end = closingBracket(val, from);
+                    break;
+                case '\"':
+                    end = stringEnd(val, from + 1);
+                    break;
+                default:
+                    return simd::find(val, ',', from);
+                }
+
+                end = end != npos ? firstNonSpace(val, end + 1) : npos;
+            }
+
+            return end != npos && val[end] == ',' ? end : npos;
+        }
+
+    private:
+        /**
+         * Reads the next object; see next().
+         */
+        template<bool Padded>
+        constexpr std::optional<object> read() {
+            if (!m_ready)
+                return {};
+
+            // Search for the name field (key of the key-value pair)
+            std::size_t nameStart, nameEnd, valueStart;
+            if (m_structure) {
+                // Jump between structural characters: quote, quote, colon
+                auto base = m_structure->offsetOf(m_body);
+                nameStart = m_structure->next(base + m_index);
+                if (nameStart != npos && m_structure->json()[nameStart] == ',')
+                    nameStart = m_structure->next(nameStart + 1);
+                nameEnd = nameStart != npos ? m_structure->next(nameStart + 1) : npos;
+                valueStart = nameEnd != npos ? m_structure->next(nameEnd + 1) : npos;
+                if (valueStart == npos || valueStart - base >= m_body.size() ||
+                    m_body[nameStart - base] != '\"' || m_body[valueStart - base] != ':')
+                {
+                    return {};
+                }
+
+                nameStart -= base;
+                nameEnd -= base;
+                valueStart -= base;
+            } else {
+                nameStart = m_body.find('\"', m_index);
+                nameEnd = nameStart != npos ? stringEnd<Padded>(m_body, nameStart + 1) : npos;
+                valueStart = nameEnd != npos ? m_body.find(':', nameEnd + 1) : npos;
+                if (valueStart == npos)
+                    return {};
+            }
+
+            // Name found; next, find the value
+            valueStart = firstNonSpace<Padded>(m_body, valueStart + 1);
+            if (valueStart == npos)
+                return {};
+
+            // Construct the object
+            auto kind = numberkind::floating;
+            auto pair = determineType<Padded>(m_body.substr(valueStart), m_structure, &kind);
+            if (!pair)
+                return {};
+            object o {
+                m_body.substr(nameStart + 1, nameEnd - nameStart - 1),
+                pair->first,
+                m_body.substr(valueStart, pair->second),
+                m_structure,
+                kind,
+                Padded
+            };
+
+            // Advance index to next object, or ready = false if
+            // this is the end.
+            m_index = firstNonSpace<Padded>(m_body, valueStart + pair->second);
+            if (m_index == npos || m_body[m_index] != ',')
+                m_ready = false;
+
+            return o;
+        }
+
+        /**
+         * Finds the quote terminating a string, a block at a time. Quotes
+         * preceded by an odd number of backslashes are skipped.
+         * @param val String to search
+         * @param from Index of the first character within the string
+         * @tparam Padded If true, val must lie within a paddedview so that
+         *                whole blocks can be classified
+         * @return Index of the terminating quote, or npos if there is none
+         */
+        template<bool Padded = false>
+        constexpr static std::size_t stringEnd(std::string_view val, std::size_t from)
+        {
+            simd::stringstate state;
+            state.inString = ~std::uint64_t(0);
+            for (; from < val.size(); from += simd::blocksize) {
+                const auto m = simd::classify(val.data() + from,
+                    Padded ? simd::blocksize : std::min(simd::blocksize, val.size() - from));
+                if (const auto quotes = simd::stringMasks(m, state).first; quotes != 0) {
+                    const auto end = from + std::countr_zero(quotes);
+                    return end < val.size() ? end : npos;
+                }
+            }
+
+            return npos;
+        }
+
+        /**
+         * Finds the bracket closing an object or array, a block at a time.
+         * Brackets within strings are skipped.
+         * @param val String to search
+         * @param open Index of the opening '{' or '['
+         * @tparam Padded If true, val must lie within a paddedview so that
+         *                whole blocks can be classified
+         * @return Index of the closing bracket, or npos if there is none
+         */
+        template<bool Padded = false>
+        constexpr static std::size_t closingBracket(std::string_view val, std::size_t open)
+        {
+            simd::stringstate state;
+            int depth = 0;
+            for (auto from = open; from < val.size(); from += simd::blocksize) {
+                const auto m = simd::classify(val.data() + from,
+                    Padded ? simd::blocksize : std::min(simd::blocksize, val.size() - from));
+                auto brackets = (m.open | m.close) & ~simd::stringMasks(m, state).second;
+                for (; brackets != 0; brackets &= brackets - 1) {
+                    const auto bit = std::countr_zero(brackets);
+                    if ((m.open >> bit) & 1) {
+                        depth++;
+                    } else if (--depth == 0) {
+                        return from + bit < val.size() ? from + bit : npos;
+                    }
                 }
             }
 
-            return result;
+            return npos;
         }
     };
 }
@@ -0,0 +1,165 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_POINTER_HPP_
+#define MINJSON_POINTER_HPP_
+
+#include "fixedstring.hpp"
+#include "objectbase.hpp"
+#include "parser.hpp"
+#include "cursor.hpp"
+
+#include <array>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace minjson
+{
+    /**
+     * A JSON Pointer (RFC 6901), split into its steps at compile time.
+     */
+    template<fixedstring Path>
+    class pointer
+    {
+        static_assert(Path.size() > 0 && Path.view()[0] == '/',
+                      "JSON pointer must begin with '/'");
+
+    public:
+        /**
+         * A single reference token: an object key, which is also an array
+         * index if it is numeric.
+         */
+        struct step
+        {
+            std::array<char, Path.size()> key {};
+            std::size_t length = 0;
+            std::size_t index = 0;
+            bool numeric = false;
+
+            constexpr std::string_view name() const {
+                return {key.data(), length};
+            }
+        };
+
+        constexpr static std::size_t size = [] {
+            std::size_t n = 0;
+            for (auto c : Path.view())
+                n += c == '/';
+            return n;
+        }();
+
+        constexpr static std::array<step, size> steps = [] {
+            std::array<step, size> s {};
+            auto path = Path.view();
+            std::size_t n = 0;
+            for (std::size_t i = 1; i <= path.size(); i++) {
+                if (i == path.size() || path[i] == '/') {
+                    auto name = s[n].name();
+                    s[n].numeric = !name.empty() &&
+                        (name.size() == 1 || name[0] != '0') &&
+                        name.find_first_not_of("0123456789") == std::string_view::npos;
+                    for (auto c : name) {
+                        constexpr auto max = std::numeric_limits<std::size_t>::max();
+                        const auto digit = static_cast<std::size_t>(c - '0');
+                        if (!s[n].numeric || s[n].index > (max - digit) / 10) {
+                            // Too large to be an index; only a key
+                            s[n].numeric = false;
+                            s[n].index = 0;
+                            break;
+                        }
+                        s[n].index = s[n].index * 10 + digit;
+                    }
+                    n++;
+                } else if (path[i] == '~' && i + 1 < path.size() &&
+                           (path[i + 1] == '0' || path[i + 1] == '1'))
+                {
+                    s[n].key[s[n].length++] = path[++i] == '0' ? '~' : '/';
+                } else {
+                    s[n].key[s[n].length++] = path[i];
+                }
+            }
+            return s;
+        }();
+
+        /**
+         * Applies step I to the given value. A key is looked for with a
+         * cursor, so members ahead of it are skipped untyped and names are
+         * compared by length before their bytes.
+         * @return The referenced value, or nothing if it does not exist
+         */
+        template<std::size_t I>
+        constexpr static std::optional<objectbase> apply(const objectbase& value) {
+            constexpr auto& s = steps[I];
+
+            if (value.type() == type::object) {
+                if (auto o = cursor(*value.getObject()).find(s.name()); o)
+                    return *o;
+            } else if constexpr (s.numeric) {
+                if (value.type() == type::array) {
+                    auto entry = value.getArrayFirst()->at(s.index);
+                    if (entry.valid())
+                        return entry;
+                }
+            }
+
+            return {};
+        }
+
+        /**
+         * Applies steps First onward to the given value.
+         */
+        template<std::size_t First, std::size_t... I>
+        constexpr static std::optional<objectbase> walk(std::optional<objectbase> value,
+                                                        std::index_sequence<I...>)
+        {
+            ((value = value ? apply<First + I>(*value) : value), ...);
+            return value;
+        }
+    };
+
+    /**
+     * Finds the value referenced by a JSON Pointer, starting from the given
+     * value. The path is parsed at compile time.
+     * @tparam Path The JSON Pointer, e.g. "/menu/items/3/label"
+     * @return The referenced value, or nothing if it does not exist
+     */
+    template<fixedstring Path>
+    constexpr std::optional<objectbase> get(const objectbase& root)
+    {
+        using ptr = pointer<Path>;
+        return ptr::template walk<0>(root, std::make_index_sequence<ptr::size>());
+    }
+
+    /**
+     * Finds the value referenced by a JSON Pointer within the given parser's
+     * data. The path is parsed at compile time.
+     * @tparam Path The JSON Pointer, e.g. "/menu/items/3/label"
+     * @return The referenced value, or nothing if it does not exist
+     */
+    template<fixedstring Path>
+    constexpr std::optional<objectbase> get(const parser& doc)
+    {
+        using ptr = pointer<Path>;
+        std::optional<objectbase> value;
+        if (auto o = cursor(doc).find(ptr::steps[0].name()); o)
+            value = *o;
+        return ptr::template walk<1>(value, std::make_index_sequence<ptr::size - 1>());
+    }
+}
+
+#endif // MINJSON_POINTER_HPP_
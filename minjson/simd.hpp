@@ -0,0 +1,629 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_SIMD_HPP_
+#define MINJSON_SIMD_HPP_
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(__PCLMUL__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Block-at-a-time kernels used to classify JSON data. Each function has a
+ * portable fallback which is also used during constant evaluation.
+ */
+namespace minjson::simd
+{
+    /**
+     * The size of a block; one bit of a std::uint64_t per byte.
+     */
+    constexpr std::size_t blocksize = 64;
+
+    /**
+     * Bitmasks of the characters of interest within a block, where bit n
+     * corresponds to byte n of the block.
+     */
+    struct blockmasks
+    {
+        std::uint64_t quote = 0;
+        std::uint64_t backslash = 0;
+        std::uint64_t open = 0;  // '{' and '['
+        std::uint64_t close = 0; // '}' and ']'
+        std::uint64_t colon = 0;
+        std::uint64_t comma = 0;
+    };
+
+    /**
+     * Classifies up to blocksize bytes, one byte at a time.
+     */
+    constexpr blockmasks classifyScalar(const char *data, std::size_t size)
+    {
+        blockmasks m;
+        for (std::size_t i = 0; i < size; i++) {
+            const auto bit = std::uint64_t(1) << i;
+            switch (data[i]) {
+            case '\"': m.quote |= bit;     break;
+            case '\\': m.backslash |= bit; break;
+            case '{':
+            case '[':  m.open |= bit;      break;
+            case '}':
+            case ']':  m.close |= bit;     break;
+            case ':':  m.colon |= bit;     break;
+            case ',':  m.comma |= bit;     break;
+            default: break;
+            }
+        }
+        return m;
+    }
+
+#if defined(__AVX2__)
+    inline std::uint64_t match32(__m256i block, char c) {
+        return static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(c))));
+    }
+
+    // Matches bytes that must be escaped in a JSON string
+    inline std::uint64_t matchSpecial32(__m256i block) {
+        const auto control = _mm256_cmpeq_epi8(
+            _mm256_subs_epu8(block, _mm256_set1_epi8(0x1f)), _mm256_setzero_si256());
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(control,
+            _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8('\"')),
+                            _mm256_cmpeq_epi8(block, _mm256_set1_epi8('\\'))))));
+    }
+
+    inline blockmasks classifyBlock(const char *data)
+    {
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 32));
+        // '{' and '[' (and '}' and ']') differ only by 0x20
+        const __m256i lo20 = _mm256_or_si256(lo, _mm256_set1_epi8(0x20));
+        const __m256i hi20 = _mm256_or_si256(hi, _mm256_set1_epi8(0x20));
+        auto both = [](__m256i l, __m256i h, char c) {
+            return match32(l, c) | (match32(h, c) << 32);
+        };
+
+        blockmasks m;
+        m.quote = both(lo, hi, '\"');
+        m.backslash = both(lo, hi, '\\');
+        m.open = both(lo20, hi20, '{');
+        m.close = both(lo20, hi20, '}');
+        m.colon = both(lo, hi, ':');
+        m.comma = both(lo, hi, ',');
+        return m;
+    }
+#elif defined(__SSE2__)
+    inline std::uint64_t match16(__m128i block, char c) {
+        return static_cast<std::uint16_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))));
+    }
+
+    // Matches bytes that must be escaped in a JSON string
+    inline std::uint64_t matchSpecial16(__m128i block) {
+        const auto control = _mm_cmpeq_epi8(
+            _mm_subs_epu8(block, _mm_set1_epi8(0x1f)), _mm_setzero_si128());
+        return static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_or_si128(control,
+            _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\"')),
+                         _mm_cmpeq_epi8(block, _mm_set1_epi8('\\'))))));
+    }
+
+    inline blockmasks classifyBlock(const char *data)
+    {
+        __m128i v[4], v20[4];
+        for (int i = 0; i < 4; i++) {
+            v[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 16));
+            v20[i] = _mm_or_si128(v[i], _mm_set1_epi8(0x20));
+        }
+        auto all = [](const __m128i *b, char c) {
+            return match16(b[0], c)         | (match16(b[1], c) << 16) |
+                   (match16(b[2], c) << 32) | (match16(b[3], c) << 48);
+        };
+
+        blockmasks m;
+        m.quote = all(v, '\"');
+        m.backslash = all(v, '\\');
+        m.open = all(v20, '{');
+        m.close = all(v20, '}');
+        m.colon = all(v, ':');
+        m.comma = all(v, ',');
+        return m;
+    }
+#endif
+
+    /**
+     * Loads eight bytes as a little-endian word.
+     */
+    constexpr std::uint64_t loadWord(const char *data)
+    {
+        if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+            std::uint64_t word;
+            std::memcpy(&word, data, sizeof(word));
+            return word;
+        }
+
+        std::uint64_t word = 0;
+        for (int i = 0; i < 8; i++)
+            word |= std::uint64_t(static_cast<unsigned char>(data[i])) << (i * 8);
+        return word;
+    }
+
+    /**
+     * Gives an eight-bit mask of the bytes in the word that equal c.
+     */
+    constexpr std::uint64_t matchWord(std::uint64_t word, char c)
+    {
+        constexpr std::uint64_t lows = 0x7f7f7f7f7f7f7f7f;
+        const auto t = word ^ (0x0101010101010101 * static_cast<unsigned char>(c));
+        const auto zeros = ~(((t & lows) + lows) | t | lows);
+        return ((zeros >> 7) * 0x0102040810204080) >> 56;
+    }
+
+    /**
+     * Gives an eight-bit mask of the bytes in the word that must be escaped
+     * in a JSON string: quotes, backslashes and control characters.
+     */
+    constexpr std::uint64_t matchSpecialWord(std::uint64_t word)
+    {
+        constexpr std::uint64_t lows = 0x7f7f7f7f7f7f7f7f;
+        // The high bit of each byte is set if it is at least 0x20
+        const auto printable = ((word & lows) + 0x6060606060606060) | word;
+        const auto control = ((~printable >> 7) & 0x0101010101010101) * 0x0102040810204080;
+        return matchWord(word, '\"') | matchWord(word, '\\') | (control >> 56);
+    }
+
+    /**
+     * Finds the first occurrence of c in the string at or after from.
+     * @return The index of c, or std::string_view::npos if not found
+     */
+    constexpr std::size_t find(std::string_view str, char c, std::size_t from = 0)
+    {
+        const auto data = str.data();
+        const auto size = str.size();
+
+        if (!std::is_constant_evaluated()) {
+#if defined(__AVX2__)
+            for (; from + 32 <= size; from += 32) {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + from));
+                if (auto mask = match32(block, c); mask != 0)
+                    return from + std::countr_zero(mask);
+            }
+#elif defined(__SSE2__)
+            for (; from + 16 <= size; from += 16) {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + from));
+                if (auto mask = match16(block, c); mask != 0)
+                    return from + std::countr_zero(mask);
+            }
+#endif
+        }
+
+        for (; from + 8 <= size; from += 8) {
+            if (auto mask = matchWord(loadWord(data + from), c); mask != 0)
+                return from + std::countr_zero(mask);
+        }
+        for (; from < size; from++) {
+            if (data[from] == c)
+                return from;
+        }
+
+        return std::string_view::npos;
+    }
+
+    /**
+     * Copies the string to out until the first occurrence of c, or until
+     * room bytes have been copied. Copies 32 (or 16) bytes at a time while
+     * there is room, so bytes of out past the stopping point may change.
+     * @return The number of bytes copied; the index of c if it was reached
+     */
+    constexpr std::size_t copyUntil(std::string_view str, char *out, std::size_t room, char c)
+    {
+        const auto data = str.data();
+        const auto size = std::min(str.size(), room);
+        std::size_t i = 0;
+
+        if (!std::is_constant_evaluated()) {
+#if defined(__AVX2__)
+            for (; i + 32 <= size; i += 32) {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), block);
+                if (auto mask = match32(block, c); mask != 0)
+                    return i + std::countr_zero(mask);
+            }
+#elif defined(__SSE2__)
+            for (; i + 16 <= size; i += 16) {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), block);
+                if (auto mask = match16(block, c); mask != 0)
+                    return i + std::countr_zero(mask);
+            }
+#endif
+        }
+
+        for (; i < size && data[i] != c; i++)
+            out[i] = data[i];
+        return i;
+    }
+
+    /**
+     * Copies the string to out until the first byte that must be escaped
+     * in a JSON string, or until room bytes have been copied. Like
+     * copyUntil(), bytes of out past the stopping point may change.
+     * @return The number of bytes copied; the index of the byte to escape
+     *         if one was reached
+     */
+    constexpr std::size_t copyPlain(std::string_view str, char *out, std::size_t room)
+    {
+        const auto data = str.data();
+        const auto size = std::min(str.size(), room);
+        std::size_t i = 0;
+
+        if (!std::is_constant_evaluated()) {
+#if defined(__AVX2__)
+            for (; i + 32 <= size; i += 32) {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), block);
+                if (auto mask = matchSpecial32(block); mask != 0)
+                    return i + std::countr_zero(mask);
+            }
+#elif defined(__SSE2__)
+            for (; i + 16 <= size; i += 16) {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), block);
+                if (auto mask = matchSpecial16(block); mask != 0)
+                    return i + std::countr_zero(mask);
+            }
+#endif
+        }
+
+        for (; i + 8 <= size; i += 8) {
+            const auto mask = matchSpecialWord(loadWord(data + i));
+            const auto n = mask != 0 ? std::countr_zero(mask) : 8;
+            for (int j = 0; j < n; j++)
+                out[i + j] = data[i + j];
+            if (n < 8)
+                return i + n;
+        }
+        for (; i < size; i++) {
+            const auto u = static_cast<unsigned char>(data[i]);
+            if (u < 0x20 || u == '\"' || u == '\\')
+                break;
+            out[i] = data[i];
+        }
+        return i;
+    }
+
+    /**
+     * Classifies a full block eight bytes at a time, using only 64-bit
+     * arithmetic (SWAR).
+     */
+    constexpr blockmasks classifySwar(const char *data)
+    {
+        blockmasks m;
+        for (int i = 0; i < 8; i++) {
+            const auto word = loadWord(data + i * 8);
+            const auto word20 = word | 0x2020202020202020;
+            const auto shift = i * 8;
+            m.quote |= matchWord(word, '\"') << shift;
+            m.backslash |= matchWord(word, '\\') << shift;
+            m.open |= matchWord(word20, '{') << shift;
+            m.close |= matchWord(word20, '}') << shift;
+            m.colon |= matchWord(word, ':') << shift;
+            m.comma |= matchWord(word, ',') << shift;
+        }
+        return m;
+    }
+
+    /**
+     * Classifies up to blocksize bytes of the given data.
+     */
+    constexpr blockmasks classify(const char *data, std::size_t size)
+    {
+        if (size == blocksize) {
+#if defined(__AVX2__) || defined(__SSE2__)
+            if (!std::is_constant_evaluated())
+                return classifyBlock(data);
+#endif
+            return classifySwar(data);
+        }
+
+        return classifyScalar(data, size);
+    }
+
+    /**
+     * Computes the prefix XOR of the given bits: bit n of the result is the
+     * parity of bits 0 through n. Given quote positions, this yields the
+     * bytes which are inside of a string (including the opening quote).
+     */
+    constexpr std::uint64_t prefixXor(std::uint64_t bits)
+    {
+#if defined(__PCLMUL__)
+        if (!std::is_constant_evaluated()) {
+            return static_cast<std::uint64_t>(_mm_cvtsi128_si64(
+                _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(bits)),
+                                     _mm_set1_epi8(-1), 0)));
+        }
+#endif
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+    /**
+     * Finds the characters escaped by a backslash; that is, those preceded by
+     * an odd-length run of backslashes. Runs may cross block boundaries.
+     * @param backslash Backslash positions of the block
+     * @param carry Set if the first character of the block is escaped;
+     *              updated for the next block
+     * @return Positions of the escaped characters
+     */
+    constexpr std::uint64_t escapes(std::uint64_t backslash, std::uint64_t& carry)
+    {
+        constexpr std::uint64_t even = 0x5555555555555555;
+
+        // An escaped backslash does not begin a run
+        backslash &= ~carry;
+        const auto follows = (backslash << 1) | carry;
+
+        // Adding the starts of odd-positioned runs to the backslashes carries
+        // through each run, flipping the parity of those runs' ends
+        const auto oddStarts = backslash & ~even & ~follows;
+        const auto evenStarts = oddStarts + backslash;
+        carry = evenStarts < oddStarts ? 1 : 0;
+
+        return (even ^ (evenStarts << 1)) & follows;
+    }
+
+    /**
+     * Carried state for stringMasks(), between consecutive blocks.
+     */
+    struct stringstate
+    {
+        std::uint64_t escaped = 0;  // Set if the next block begins escaped
+        std::uint64_t inString = 0; // All ones if the next block begins in a string
+    };
+
+    /**
+     * Locates the strings within a block.
+     * @param m The block's classification
+     * @param state State carried from the previous block
+     * @return A pair of the unescaped quotes, and the bytes within strings
+     *         (including opening quotes but not closing ones)
+     */
+    constexpr std::pair<std::uint64_t, std::uint64_t>
+        stringMasks(const blockmasks& m, stringstate& state)
+    {
+        const auto quotes = m.quote & ~escapes(m.backslash, state.escaped);
+        const auto strings = prefixXor(quotes) ^ state.inString;
+        state.inString = static_cast<std::uint64_t>(static_cast<std::int64_t>(strings) >> 63);
+        return {quotes, strings};
+    }
+
+    /**
+     * Carried state for validateUtf8(), between consecutive pieces of data.
+     */
+    struct utf8state
+    {
+        std::uint32_t tail = 0; // The last four bytes seen, the latest highest
+        bool error = false;     // Set once invalid UTF-8 has been seen
+
+        /**
+         * Tells if the data seen so far ends partway through a character.
+         */
+        constexpr bool incomplete() const {
+            return (tail >> 24) >= 0xc0 || ((tail >> 16) & 0xff) >= 0xe0 ||
+                   ((tail >> 8) & 0xff) >= 0xf0;
+        }
+
+        /**
+         * Tells if the data seen so far is complete, valid UTF-8.
+         */
+        constexpr bool valid() const {
+            return !error && !incomplete();
+        }
+    };
+
+    /**
+     * Validates UTF-8 one byte at a time, skipping ASCII eight bytes at a
+     * time.
+     */
+    constexpr void validateUtf8Scalar(const char *data, std::size_t size, utf8state& state)
+    {
+        // Continuation bytes still needed, and the range allowed for the next
+        unsigned need = 0;
+        unsigned low = 0x80;
+        unsigned high = 0xbf;
+
+        auto step = [&](unsigned c) {
+            if (need > 0) {
+                const bool ok = c >= low && c <= high;
+                need = ok ? need - 1 : 0;
+                low = 0x80;
+                high = 0xbf;
+                return ok;
+            }
+
+            if (c < 0x80)
+                return true;
+            else if (c >= 0xc2 && c <= 0xdf)
+                need = 1;
+            else if (c >= 0xe0 && c <= 0xef)
+                need = 2;
+            else if (c >= 0xf0 && c <= 0xf4)
+                need = 3;
+            else
+                return false;
+
+            // Exclude overlong forms, surrogates, and points past U+10FFFF
+            if (c == 0xe0)
+                low = 0xa0;
+            else if (c == 0xed)
+                high = 0x9f;
+            else if (c == 0xf0)
+                low = 0x90;
+            else if (c == 0xf4)
+                high = 0x8f;
+            return true;
+        };
+
+        // Resume a character begun in the previous data. An invalid lead byte
+        // at the end of a SIMD block is only caught here.
+        const unsigned last[3] = { (state.tail >> 8) & 0xff, (state.tail >> 16) & 0xff,
+                                   state.tail >> 24 };
+        bool ok = true;
+        if (last[2] >= 0xc0) {
+            ok &= step(last[2]);
+        } else if (last[1] >= 0xe0) {
+            ok &= step(last[1]);
+            ok &= step(last[2]);
+        } else if (last[0] >= 0xf0) {
+            for (auto c : last)
+                ok &= step(c);
+        }
+
+        for (std::size_t i = 0; i < size;) {
+            if (need == 0 && i + 8 <= size &&
+                (loadWord(data + i) & 0x8080808080808080) == 0)
+            {
+                i += 8;
+            } else {
+                ok &= step(static_cast<unsigned char>(data[i++]));
+            }
+        }
+
+        state.error |= !ok;
+        for (auto i = size > 4 ? size - 4 : 0; i < size; i++)
+            state.tail = (state.tail >> 8) | (std::uint32_t(static_cast<unsigned char>(data[i])) << 24);
+    }
+
+#if defined(__AVX2__)
+    /**
+     * Finds UTF-8 errors in 32 bytes with table lookups on each byte's
+     * nibbles and those of the three bytes before it (Keiser and Lemire,
+     * "Validating UTF-8 In Less Than One Instruction Per Byte").
+     * @return Non-zero bytes where there are errors
+     */
+    inline __m256i utf8Errors(__m256i input, __m256i previous)
+    {
+        // Error kinds, as found from the first and second byte of a pair
+        constexpr char tooShort = 1 << 0;   // Lead not followed by a continuation
+        constexpr char tooLong = 1 << 1;    // Continuation without a lead
+        constexpr char overlong3 = 1 << 2;
+        constexpr char tooLarge = 1 << 3;
+        constexpr char surrogate = 1 << 4;
+        constexpr char overlong2 = 1 << 5;
+        constexpr char tooLarge1000 = 1 << 6;
+        constexpr char overlong4 = 1 << 6;
+        constexpr char twoConts = static_cast<char>(1 << 7);
+        constexpr char carry = tooShort | tooLong | twoConts;
+
+        const auto byte1High = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+            tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong, tooLong,
+            twoConts, twoConts, twoConts, twoConts,
+            tooShort | overlong2,
+            tooShort,
+            tooShort | overlong3 | surrogate,
+            tooShort | tooLarge | tooLarge1000 | overlong4));
+        const auto byte1Low = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+            carry | overlong3 | overlong2 | overlong4,
+            carry | overlong2,
+            carry,
+            carry,
+            carry | tooLarge,
+            carry | tooLarge | tooLarge1000,
+            carry | tooLarge | tooLarge1000,
+            carry | tooLarge | tooLarge1000,
+            carry | tooLarge | tooLarge1000,
+            carry | tooLarge | tooLarge1000,
+            carry | tooLarge | tooLarge1000,
+            carry | tooLarge | tooLarge1000,
+            carry | tooLarge | tooLarge1000,
+            carry | tooLarge | tooLarge1000 | surrogate,
+            carry | tooLarge | tooLarge1000,
+            carry | tooLarge | tooLarge1000));
+        const auto byte2High = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+            tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort, tooShort,
+            tooLong | overlong2 | twoConts | overlong3 | tooLarge1000 | overlong4,
+            tooLong | overlong2 | twoConts | overlong3 | tooLarge,
+            tooLong | overlong2 | twoConts | surrogate | tooLarge,
+            tooLong | overlong2 | twoConts | surrogate | tooLarge,
+            tooShort, tooShort, tooShort, tooShort));
+
+        const auto nibbles = _mm256_set1_epi8(0x0f);
+        const auto joined = _mm256_permute2x128_si256(previous, input, 0x21);
+        const auto prev1 = _mm256_alignr_epi8(input, joined, 15);
+        const auto prev2 = _mm256_alignr_epi8(input, joined, 14);
+        const auto prev3 = _mm256_alignr_epi8(input, joined, 13);
+
+        const auto special = _mm256_and_si256(_mm256_and_si256(
+            _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibbles)),
+            _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, nibbles))),
+            _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibbles)));
+
+        // The third and fourth bytes of a character must be continuations
+        const auto must23 = _mm256_or_si256(
+            _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xe0 - 0x80))),
+            _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xf0 - 0x80))));
+        return _mm256_xor_si256(_mm256_and_si256(must23, _mm256_set1_epi8(static_cast<char>(0x80))),
+                                special);
+    }
+
+    inline void validateUtf8Block(const char *data, utf8state& state)
+    {
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + 32));
+
+        if (_mm256_movemask_epi8(_mm256_or_si256(lo, hi)) == 0) {
+            // ASCII only: just check that no character was left unfinished
+            state.error |= state.incomplete();
+        } else {
+            const auto previous = _mm256_insert_epi32(_mm256_setzero_si256(),
+                                                      static_cast<int>(state.tail), 7);
+            const auto errors = _mm256_or_si256(utf8Errors(lo, previous), utf8Errors(hi, lo));
+            state.error |= !_mm256_testz_si256(errors, errors);
+        }
+
+        std::memcpy(&state.tail, data + blocksize - 4, sizeof(state.tail));
+    }
+#endif
+
+    /**
+     * Validates a piece of UTF-8 data, which may continue from earlier pieces.
+     * Once all data is given, state.valid() tells if all of it was valid.
+     */
+    constexpr void validateUtf8(const char *data, std::size_t size, utf8state& state)
+    {
+#if defined(__AVX2__)
+        if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+            for (; size >= blocksize; data += blocksize, size -= blocksize)
+                validateUtf8Block(data, state);
+        }
+#endif
+        validateUtf8Scalar(data, size, state);
+    }
+}
+
+#endif // MINJSON_SIMD_HPP_
@@ -0,0 +1,278 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_STATICINDEX_HPP_
+#define MINJSON_STATICINDEX_HPP_
+
+#include "charclass.hpp"
+#include "document.hpp"
+#include "fixedstring.hpp"
+#include "keycache.hpp"
+#include "objectbase.hpp"
+#include "parser.hpp"
+#include "type.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * A table of every value within a JSON object, built at compile time.
+     * Each value is listed under its path as a JSON Pointer, with numbers
+     * and booleans already decoded. Looking up a path known at compile time
+     * is then an array index; other paths take a hash table lookup. No
+     * parsing is left for run time.
+     *
+     * With GCC's default limits, documents of around 50 KB can be indexed.
+     * Clang's default limit is lower; raise it with -fconstexpr-steps.
+     *
+     * @tparam Json The JSON data, which must be an object
+     */
+    template<fixedstring Json>
+    class staticindex
+    {
+    public:
+        /**
+         * A value within the data.
+         */
+        struct entry
+        {
+            std::string_view path;      // JSON Pointer to the value; "" for the root
+            objectbase value;           // The value as found in the data
+            bool boolean = false;       // The value, if a boolean
+            double number = 0;          // The value, if a number
+            std::optional<std::int64_t> integer; // The integer part of the
+                                                 // value, if a number that fits
+
+            constexpr minjson::type type() const {
+                return value.type();
+            }
+        };
+
+    private:
+        using pathbuffer = std::array<char, 2 * Json.size() + 1>;
+
+        /**
+         * Calls fn(path, value) for the given value and every value within
+         * it, in document order.
+         * @return False if the data is not valid JSON
+         */
+        template<typename F>
+        consteval static bool walk(const objectbase& value, pathbuffer& path,
+                                   std::size_t length, F& fn)
+        {
+            fn(std::string_view(path.data(), length), value);
+
+            const auto raw = value.raw();
+            if (value.type() == type::object) {
+                if (firstNonSpace(raw.substr(1, raw.size() - 2)) == std::string_view::npos)
+                    return true;
+
+                for (auto p = *value.getObject(); p.ready();) {
+                    auto o = p.next();
+                    if (!o)
+                        return false;
+
+                    // Keys are escaped as by RFC 6901
+                    auto end = length;
+                    path[end++] = '/';
+                    for (auto c : o->name()) {
+                        if (c == '~' || c == '/') {
+                            path[end++] = '~';
+                            c = c == '~' ? '0' : '1';
+                        }
+                        path[end++] = c;
+                    }
+                    if (!walk(*o, path, end, fn))
+                        return false;
+                }
+            } else if (value.type() == type::array) {
+                if (firstNonSpace(raw.substr(1, raw.size() - 2)) == std::string_view::npos)
+                    return true;
+
+                std::size_t index = 0;
+                for (auto a = *value.getArrayFirst(); a.valid(); a.next(), index++) {
+                    char digits[20] {};
+                    std::size_t count = 0;
+                    for (auto n = index; count == 0 || n > 0; n /= 10)
+                        digits[count++] = static_cast<char>('0' + n % 10);
+
+                    auto end = length;
+                    path[end++] = '/';
+                    while (count > 0)
+                        path[end++] = digits[--count];
+                    if (!walk(a, path, end, fn))
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * Walks the entire data. A document is built first so that each value
+         * is only scanned once, which keeps within the compiler's limits on
+         * constant evaluation for longer.
+         */
+        template<typename F>
+        consteval static bool walkAll(F&& fn) {
+            std::array<std::uint64_t, structuralindex::storageSize(Json.size())> storage {};
+            std::array<std::uint32_t, document::tableSize(Json.view())> table {};
+            document doc;
+            parser p;
+            if (!doc.build(Json.view(), storage, table) || !p.start(doc))
+                return false;
+
+            const auto from = firstNonSpace(Json.view());
+            const auto to = lastNonSpace(Json.view());
+            pathbuffer path {};
+            return walk(object(std::string_view(), type::object,
+                               Json.view().substr(from, to - from + 1), &doc),
+                        path, 0, fn);
+        }
+
+        struct counts
+        {
+            std::size_t entries = 0;
+            std::size_t chars = 0;
+            bool valid = false;
+        };
+
+        constexpr static counts totals = []() consteval {
+            counts c;
+            c.valid = walkAll([&c](std::string_view path, const objectbase&) {
+                c.entries++;
+                c.chars += path.size();
+            });
+            return c;
+        }();
+
+        static_assert(totals.valid, "staticindex requires a valid JSON object");
+
+        /**
+         * Storage for every path, one after another.
+         */
+        constexpr static std::array<char, totals.chars> paths = []() consteval {
+            std::array<char, totals.chars> p {};
+            std::size_t n = 0;
+            walkAll([&](std::string_view path, const objectbase&) {
+                for (auto c : path)
+                    p[n++] = c;
+            });
+            return p;
+        }();
+
+    public:
+        /**
+         * The number of values in the data, including the root object.
+         */
+        constexpr static std::size_t size = totals.entries;
+
+        /**
+         * Every value in the data, in document order.
+         */
+        constexpr static std::array<entry, size> entries = []() consteval {
+            std::array<entry, size> e {};
+            std::size_t n = 0;
+            std::size_t offset = 0;
+            walkAll([&](std::string_view path, const objectbase& value) {
+                auto& en = e[n++];
+                en.path = std::string_view(paths.data() + offset, path.size());
+                en.value = objectbase(value.type(), value.raw(), nullptr,
+                                      value.numberkind());
+                offset += path.size();
+
+                if (value.type() == type::boolean) {
+                    en.boolean = *value.get<bool>();
+                } else if (value.type() == type::number) {
+                    // Integers within 2^53 convert exactly, without decoding
+                    en.integer = value.get<std::int64_t>();
+                    constexpr std::int64_t exact = std::int64_t(1) << 53;
+                    if (value.numberkind() == numberkind::int64 &&
+                        *en.integer >= -exact && *en.integer <= exact)
+                    {
+                        en.number = static_cast<double>(*en.integer);
+                    } else {
+                        en.number = value.get<double>().value_or(0);
+                    }
+                }
+            });
+            return e;
+        }();
+
+    private:
+        /**
+         * An open-addressed hash table of the paths, holding the index of
+         * each path's entry plus one; zero marks an empty slot. At most 3/4
+         * of the slots are used.
+         */
+        constexpr static std::size_t slotCount = std::bit_ceil(size * 4 / 3 + 1);
+
+        constexpr static std::array<std::uint32_t, slotCount> slots = []() consteval {
+            std::array<std::uint32_t, slotCount> s {};
+            for (std::size_t i = 0; i < size; i++) {
+                auto slot = keycache<slotCount>::hash(entries[i].path) & (slotCount - 1);
+                while (s[slot] != 0)
+                    slot = (slot + 1) & (slotCount - 1);
+                s[slot] = static_cast<std::uint32_t>(i + 1);
+            }
+            return s;
+        }();
+
+    public:
+        /**
+         * Finds the index of the value with the given path.
+         * @return The index within entries, or size if there is none
+         */
+        constexpr static std::size_t indexOf(std::string_view path) {
+            auto slot = keycache<slotCount>::hash(path) & (slotCount - 1);
+            for (; slots[slot] != 0; slot = (slot + 1) & (slotCount - 1)) {
+                if (entries[slots[slot] - 1].path == path)
+                    return slots[slot] - 1;
+            }
+
+            return size;
+        }
+
+        /**
+         * Finds the value with the given path.
+         * @param path JSON Pointer to the value, e.g. "/uart/baud"
+         * @return The value, or nullptr if there is none
+         */
+        constexpr static const entry *find(std::string_view path) {
+            const auto i = indexOf(path);
+            return i < size ? &entries[i] : nullptr;
+        }
+
+        /**
+         * Gives the value with the given path, which is found at compile
+         * time.
+         * @tparam Path JSON Pointer to the value, e.g. "/uart/baud"
+         */
+        template<fixedstring Path>
+        constexpr static const entry& at() {
+            constexpr auto i = indexOf(Path.view());
+            static_assert(i < size, "path not found in staticindex");
+            return entries[i];
+        }
+    };
+}
+
+#endif // MINJSON_STATICINDEX_HPP_
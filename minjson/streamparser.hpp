@@ -0,0 +1,292 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_STREAMPARSER_HPP_
+#define MINJSON_STREAMPARSER_HPP_
+
+#include "charclass.hpp"
+#include "object.hpp"
+#include "parser.hpp"
+#include "simd.hpp"
+#include "type.hpp"
+
+#include <span>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * Parses a JSON object that arrives in pieces, such as from a socket or a
+     * DMA buffer. Each of the object's members is emitted once complete.
+     *
+     * Members that lie within a single chunk are emitted straight from that
+     * chunk. Only a member that is split across chunks is copied, into a
+     * caller-provided buffer, so the buffer need only be as large as the
+     * largest member rather than the whole document.
+     */
+    class streamparser
+    {
+    private:
+        enum class state
+        {
+            begin,      // Expecting the opening '{'
+            member,     // Expecting a key, or '}' if the object is empty
+            key,        // Within a key
+            colon,      // Expecting ':'
+            value,      // Expecting a value
+            scalar,     // Within a number, boolean or null
+            string,     // Within a string value
+            container,  // Within an object or array value
+            next,       // Expecting ',' or '}'
+            done,
+            error
+        };
+
+        constexpr static auto npos = std::string_view::npos;
+
+        std::span<char> m_buffer; // Holds a member split across chunks
+        validation m_check;
+        simd::utf8state m_utf8;   // Validation state carried across chunks
+        std::size_t m_length;     // Bytes of the current member in m_buffer
+        std::size_t m_begin;      // Where the current member began in the chunk
+        state m_state;
+        std::size_t m_keyEnd;     // Offset of the key's closing quote
+        std::size_t m_valueStart; // Offset of the member's value
+        std::size_t m_depth;      // Nesting depth within a container
+        bool m_escape;            // Set if the next character is escaped
+        bool m_inString;          // Set if within a string in a container
+        bool m_empty;             // Set until a member has been read
+
+    public:
+        /**
+         * @param buffer Storage for members that are split across chunks
+         * @param check Validation of the data, carried across chunks
+         */
+        constexpr streamparser(std::span<char> buffer,
+                               validation check = validation::none) :
+            m_buffer(buffer), m_check(check)
+        {
+            reset();
+        }
+
+        /**
+         * Prepares to parse a new object.
+         */
+        constexpr void reset() {
+            m_utf8 = {};
+            m_length = 0;
+            m_begin = npos;
+            m_state = state::begin;
+            m_keyEnd = 0;
+            m_valueStart = 0;
+            m_depth = 0;
+            m_escape = false;
+            m_inString = false;
+            m_empty = true;
+        }
+
+        /**
+         * Tells if the object's closing '}' has been reached.
+         */
+        constexpr bool done() const {
+            return m_state == state::done;
+        }
+
+        /**
+         * Tells if invalid JSON (or data failing validation) was found, or a
+         * member did not fit in the buffer.
+         */
+        constexpr bool failed() const {
+            return m_state == state::error;
+        }
+
+        /**
+         * Parses the next chunk of JSON data.
+         * @param chunk The data, which need only live until feed() returns
+         * @param emit Called with each member (a minjson::object) completed by
+         *             this chunk; the object is only valid during the call
+         * @return False on error
+         */
+        template<typename F>
+        constexpr bool feed(std::string_view chunk, F&& emit) {
+            // Offset of chunk[i] within the current member
+            auto offset = [&](std::size_t i) { return m_length + i - m_begin; };
+
+            if (m_check == validation::utf8 && m_state != state::error) {
+                simd::validateUtf8(chunk.data(), chunk.size(), m_utf8);
+                if (m_utf8.error)
+                    m_state = state::error;
+            }
+
+            for (std::size_t i = 0; i < chunk.size(); i++) {
+                const char c = chunk[i];
+                const bool space = classOf(c) == charclass::space;
+
+                switch (m_state) {
+                case state::begin:
+                    if (c == '{')
+                        m_state = state::member;
+                    else if (!space)
+                        m_state = state::error;
+                    break;
+                case state::member:
+                    if (c == '\"') {
+                        m_begin = i;
+                        m_state = state::key;
+                    } else if (c == '}' && m_empty) {
+                        m_state = state::done;
+                    } else if (!space) {
+                        m_state = state::error;
+                    }
+                    break;
+                case state::key:
+                    if (m_escape) {
+                        m_escape = false;
+                    } else if (c == '\\') {
+                        m_escape = true;
+                    } else if (c == '\"') {
+                        m_keyEnd = offset(i);
+                        m_state = state::colon;
+                    }
+                    break;
+                case state::colon:
+                    if (c == ':')
+                        m_state = state::value;
+                    else if (!space)
+                        m_state = state::error;
+                    break;
+                case state::value:
+                    if (!space) {
+                        m_valueStart = offset(i);
+                        if (c == '\"') {
+                            m_state = state::string;
+                        } else if (c == '{' || c == '[') {
+                            m_depth = 1;
+                            m_state = state::container;
+                        } else if (c == ',' || c == '}' || c == ']' || c == ':') {
+                            m_state = state::error;
+                        } else {
+                            m_state = state::scalar;
+                        }
+                    }
+                    break;
+                case state::scalar:
+                    if (space || c == ',' || c == '}') {
+                        // The delimiter belongs to the next state
+                        finish(chunk, i, emit);
+                        i--;
+                    }
+                    break;
+                case state::string:
+                    if (m_escape)
+                        m_escape = false;
+                    else if (c == '\\')
+                        m_escape = true;
+                    else if (c == '\"')
+                        finish(chunk, i + 1, emit);
+                    break;
+                case state::container:
+                    if (m_escape) {
+                        m_escape = false;
+                    } else if (m_inString) {
+                        if (c == '\\')
+                            m_escape = true;
+                        else if (c == '\"')
+                            m_inString = false;
+                    } else if (c == '\"') {
+                        m_inString = true;
+                    } else if (c == '{' || c == '[') {
+                        m_depth++;
+                    } else if ((c == '}' || c == ']') && --m_depth == 0) {
+                        finish(chunk, i + 1, emit);
+                    }
+                    break;
+                case state::next:
+                    if (c == ',')
+                        m_state = state::member;
+                    else if (c == '}')
+                        m_state = state::done;
+                    else if (!space)
+                        m_state = state::error;
+                    break;
+                case state::done:
+                    if (!space)
+                        m_state = state::error;
+                    break;
+                case state::error:
+                    return false;
+                }
+            }
+
+            // Keep the part of an unfinished member for the next chunk
+            if (m_begin != npos && m_state != state::error) {
+                if (!append(chunk.substr(m_begin)))
+                    m_state = state::error;
+                m_begin = 0;
+            }
+
+            return m_state != state::error;
+        }
+
+    private:
+        /**
+         * Copies part of a member into the buffer.
+         */
+        constexpr bool append(std::string_view data) {
+            if (data.size() > m_buffer.size() - m_length)
+                return false;
+
+            for (auto c : data)
+                m_buffer[m_length++] = c;
+            return true;
+        }
+
+        /**
+         * Emits the current member, which ends before chunk[end].
+         */
+        template<typename F>
+        constexpr void finish(std::string_view chunk, std::size_t end, F& emit) {
+            std::string_view text;
+            if (m_length == 0) {
+                // The entire member is within this chunk
+                text = chunk.substr(m_begin, end - m_begin);
+            } else if (append(chunk.substr(0, end))) {
+                text = {m_buffer.data(), m_length};
+            } else {
+                m_state = state::error;
+                return;
+            }
+
+            auto value = text.substr(m_valueStart);
+            auto kind = numberkind::floating;
+            auto pair = parser::determineType(value, nullptr, &kind);
+            if (!pair || pair->second != value.size()) {
+                m_state = state::error;
+                return;
+            }
+
+            const object o {text.substr(1, m_keyEnd - 1), pair->first, value, nullptr, kind};
+            emit(o);
+
+            m_length = 0;
+            m_begin = npos;
+            m_empty = false;
+            m_state = state::next;
+        }
+    };
+}
+
+#endif // MINJSON_STREAMPARSER_HPP_
@@ -0,0 +1,211 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_STRUCTURALINDEX_HPP_
+#define MINJSON_STRUCTURALINDEX_HPP_
+
+#include "simd.hpp"
+#include "type.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * A bitmap marking the positions of all structural characters in a JSON
+     * string: string quotes, and any brackets, colons or commas that are not
+     * within a string. Once built, the parser can jump between these positions
+     * rather than scanning every byte.
+     *
+     * The index does not own any memory; storage is provided by the caller.
+     */
+    class structuralindex
+    {
+    protected:
+        std::string_view m_json;
+        std::span<const std::uint64_t> m_bits;
+        bool m_utf8 = false; // Set if the data was validated as UTF-8
+
+        // Optional jump table, see minjson::document
+        std::span<const std::uint32_t> m_ranks; // Openers before each block
+        std::span<const std::uint32_t> m_closers; // Close position per opener
+
+    public:
+        constexpr static auto npos = std::string_view::npos;
+
+        /**
+         * Gives the number of words of storage needed to index the given
+         * length of JSON data.
+         */
+        constexpr static std::size_t storageSize(std::size_t length) {
+            return (length + simd::blocksize - 1) / simd::blocksize;
+        }
+
+        constexpr structuralindex() = default;
+
+        /**
+         * Builds the index for the given JSON data.
+         * @param json The JSON data, which must outlive the index
+         * @param storage Storage for the bitmap, of at least storageSize() words
+         * @param check Validation to do while indexing, in the same pass
+         * @return True if successful; false if storage is too small, a string
+         *         is left unterminated, or validation fails
+         */
+        constexpr bool build(std::string_view json, std::span<std::uint64_t> storage,
+                             validation check = validation::none)
+        {
+            m_json = {};
+            m_bits = {};
+            m_utf8 = false;
+            m_ranks = {};
+            m_closers = {};
+
+            const auto words = storageSize(json.size());
+            if (storage.size() < words)
+                return false;
+
+            simd::stringstate state;
+            simd::utf8state utf8;
+            for (std::size_t i = 0; i < words; i++) {
+                const auto offset = i * simd::blocksize;
+                const auto size = std::min(simd::blocksize, json.size() - offset);
+                const auto m = simd::classify(json.data() + offset, size);
+
+                const auto [quotes, strings] = simd::stringMasks(m, state);
+                storage[i] = ((m.open | m.close | m.colon | m.comma) & ~strings) | quotes;
+
+                if (check == validation::utf8)
+                    simd::validateUtf8(json.data() + offset, size, utf8);
+            }
+
+            if (state.inString != 0 || (check == validation::utf8 && !utf8.valid()))
+                return false;
+
+            m_json = json;
+            m_bits = storage.first(words);
+            m_utf8 = check == validation::utf8;
+            return true;
+        }
+
+        /**
+         * Tells if the data was found to be valid UTF-8 when the index was
+         * built.
+         */
+        constexpr bool utf8() const {
+            return m_utf8;
+        }
+
+        /**
+         * Returns the indexed JSON data.
+         */
+        constexpr std::string_view json() const {
+            return m_json;
+        }
+
+        /**
+         * Gives the offset of the given view within the indexed data, or npos
+         * if the view does not lie within it.
+         */
+        constexpr std::size_t offsetOf(std::string_view v) const {
+            if (!std::is_constant_evaluated()) {
+                std::less_equal<const char *> le;
+                if (!le(m_json.data(), v.data()) ||
+                    !le(v.data() + v.size(), m_json.data() + m_json.size()))
+                {
+                    return npos;
+                }
+            }
+
+            return static_cast<std::size_t>(v.data() - m_json.data());
+        }
+
+        /**
+         * Finds the first structural character at or after the given position.
+         * @return The character's position, or npos if there are none
+         */
+        constexpr std::size_t next(std::size_t pos) const {
+            auto word = pos / simd::blocksize;
+            if (word >= m_bits.size())
+                return npos;
+
+            auto bits = m_bits[word] & (~std::uint64_t(0) << (pos % simd::blocksize));
+            while (bits == 0) {
+                if (++word >= m_bits.size())
+                    return npos;
+                bits = m_bits[word];
+            }
+
+            return word * simd::blocksize + std::countr_zero(bits);
+        }
+
+        /**
+         * Finds the bracket that closes the one at the given position.
+         * @param open Position of a '{' or '['
+         * @return Position of the matching '}' or ']', or npos if unbalanced
+         */
+        constexpr std::size_t closing(std::size_t open) const {
+            if (open / simd::blocksize >= m_bits.size())
+                return npos;
+
+            if (!m_closers.empty()) {
+                // Count the openers before this one to find its table entry
+                const auto word = open / simd::blocksize;
+                auto rank = m_ranks[word];
+                auto bits = m_bits[word] & ~(~std::uint64_t(0) << (open % simd::blocksize));
+                for (; bits != 0; bits &= bits - 1) {
+                    auto c = m_json[word * simd::blocksize + std::countr_zero(bits)];
+                    if (c == '{' || c == '[')
+                        rank++;
+                }
+
+                return rank < m_closers.size() ? m_closers[rank] : npos;
+            }
+
+            int depth = 0;
+            for (auto word = open / simd::blocksize; word < m_bits.size(); word++) {
+                auto bits = m_bits[word];
+                if (word == open / simd::blocksize)
+                    bits &= ~std::uint64_t(0) << (open % simd::blocksize);
+
+                for (; bits != 0; bits &= bits - 1) {
+                    const auto pos = word * simd::blocksize + std::countr_zero(bits);
+                    switch (m_json[pos]) {
+                    case '{':
+                    case '[':
+                        depth++;
+                        break;
+                    case '}':
+                    case ']':
+                        if (--depth == 0)
+                            return pos;
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+
+            return npos;
+        }
+    };
+}
+
+#endif // MINJSON_STRUCTURALINDEX_HPP_
@@ -31,6 +31,26 @@ namespace minjson
         boolean,
         null
     };
+
+    /**
+     * Enumerates the ranges a JSON number can fall within. Numbers with a
+     * fraction or exponent, or that fit in neither integer type, are floating.
+     */
+    enum class numberkind
+    {
+        int64,
+        uint64,
+        floating
+    };
+
+    /**
+     * Selects the checks made on JSON data beyond those needed to parse it.
+     */
+    enum class validation
+    {
+        none,
+        utf8  // Data must be valid UTF-8
+    };
 }
 
 #endif // MINJSON_TYPE_HPP_
@@ -0,0 +1,263 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_VISIT_HPP_
+#define MINJSON_VISIT_HPP_
+
+#include "charclass.hpp"
+#include "objectbase.hpp"
+#include "parser.hpp"
+#include "type.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+namespace minjson
+{
+    /**
+     * Calls a handler's callbacks for a JSON document; see visit().
+     * Callbacks the handler does not define are skipped at compile time.
+     */
+    template<typename Handler>
+    class visitor
+    {
+    private:
+        Handler& m_handler;
+
+        /**
+         * Gives the result of a callback, which may return bool to stop the
+         * walk early or return nothing.
+         */
+        template<typename F>
+        constexpr static bool result(F&& callback) {
+            if constexpr (std::is_same_v<decltype(callback()), bool>) {
+                return callback();
+            } else {
+                callback();
+                return true;
+            }
+        }
+
+    public:
+        constexpr visitor(Handler& handler) :
+            m_handler(handler) {}
+
+        constexpr bool beginObject() {
+            if constexpr (requires { m_handler.on_begin_object(); })
+                return result([this] { return m_handler.on_begin_object(); });
+            return true;
+        }
+
+        constexpr bool endObject() {
+            if constexpr (requires { m_handler.on_end_object(); })
+                return result([this] { return m_handler.on_end_object(); });
+            return true;
+        }
+
+        constexpr bool beginArray() {
+            if constexpr (requires { m_handler.on_begin_array(); })
+                return result([this] { return m_handler.on_begin_array(); });
+            return true;
+        }
+
+        constexpr bool endArray() {
+            if constexpr (requires { m_handler.on_end_array(); })
+                return result([this] { return m_handler.on_end_array(); });
+            return true;
+        }
+
+        constexpr bool key(std::string_view name) {
+            if constexpr (requires { m_handler.on_key(name); })
+                return result([&] { return m_handler.on_key(name); });
+            return true;
+        }
+
+        constexpr bool string(std::string_view str) {
+            if constexpr (requires { m_handler.on_string(str); })
+                return result([&] { return m_handler.on_string(str); });
+            return true;
+        }
+
+        constexpr bool number(const objectbase& n) {
+            if constexpr (requires { m_handler.on_number(n); })
+                return result([&] { return m_handler.on_number(n); });
+            return true;
+        }
+
+        constexpr bool boolean(bool b) {
+            if constexpr (requires { m_handler.on_boolean(b); })
+                return result([&] { return m_handler.on_boolean(b); });
+            return true;
+        }
+
+        constexpr bool null() {
+            if constexpr (requires { m_handler.on_null(); })
+                return result([this] { return m_handler.on_null(); });
+            return true;
+        }
+    };
+
+    /**
+     * Walks a JSON document in a single forward pass, calling the handler
+     * for each part of it in order. The handler may define any of:
+     *
+     *     on_begin_object(), on_end_object(), on_begin_array(), on_end_array(),
+     *     on_key(std::string_view), on_string(std::string_view),
+     *     on_number(const objectbase&), on_boolean(bool), on_null()
+     *
+     * Keys and strings are given as they appear within their quotes; see
+     * unescape(). Numbers are given as objectbase, to be read with get().
+     * A callback may return false to stop the walk.
+     *
+     * Nothing is allocated and no parser is built for nested values; each
+     * value is scanned once. Up to 64 levels of nesting are supported.
+     * @param json The JSON document, which may be any JSON value
+     * @param handler The handler
+     * @return True if the whole document was visited; false if it is invalid,
+     *         nested too deeply, or a callback stopped the walk
+     */
+    template<typename Handler>
+    constexpr bool visit(std::string_view json, Handler& handler)
+    {
+        constexpr std::size_t maxDepth = 64;
+        constexpr auto npos = std::string_view::npos;
+
+        // What is expected next
+        enum class expect { value, firstValue, key, firstKey, next };
+
+        visitor<Handler> v (handler);
+        std::uint64_t arrays = 0; // Bit n is set if level n is an array
+        std::size_t depth = 0;
+        auto state = expect::value;
+
+        for (auto i = firstNonSpace(json); i != npos; i = firstNonSpace(json, i)) {
+            const char c = json[i];
+            switch (state) {
+            case expect::firstKey:
+            case expect::key:
+                if (c == '}' && state == expect::firstKey) {
+                    state = expect::next;
+                    if (!v.endObject())
+                        return false;
+                    depth--;
+                    i++;
+                } else if (c == '\"') {
+                    auto pair = parser::determineType(json.substr(i));
+                    if (!pair || !v.key(json.substr(i + 1, pair->second - 2)))
+                        return false;
+                    i = firstNonSpace(json, i + pair->second);
+                    if (i == npos || json[i] != ':')
+                        return false;
+                    state = expect::value;
+                    i++;
+                } else {
+                    return false;
+                }
+                break;
+            case expect::firstValue:
+                if (c == ']') {
+                    state = expect::next;
+                    if (!v.endArray())
+                        return false;
+                    depth--;
+                    i++;
+                    break;
+                }
+                [[fallthrough]];
+            case expect::value:
+                state = expect::next;
+                if (c == '{' || c == '[') {
+                    if (depth == maxDepth)
+                        return false;
+
+                    const auto bit = std::uint64_t(1) << depth++;
+                    if (c == '{') {
+                        arrays &= ~bit;
+                        state = expect::firstKey;
+                        if (!v.beginObject())
+                            return false;
+                    } else {
+                        arrays |= bit;
+                        state = expect::firstValue;
+                        if (!v.beginArray())
+                            return false;
+                    }
+                    i++;
+                } else {
+                    // A scalar, scanned but not converted
+                    auto kind = numberkind::floating;
+                    auto pair = parser::determineType(json.substr(i), nullptr, &kind);
+                    if (!pair || pair->second == 0)
+                        return false;
+
+                    const auto value = json.substr(i, pair->second);
+                    bool more = true;
+                    switch (pair->first) {
+                    case type::string:
+                        more = v.string(value.substr(1, value.size() - 2));
+                        break;
+                    case type::number:
+                        more = v.number(objectbase(type::number, value, nullptr, kind));
+                        break;
+                    case type::boolean:
+                        more = v.boolean(c == 't');
+                        break;
+                    default:
+                        more = v.null();
+                        break;
+                    }
+
+                    if (!more)
+                        return false;
+                    i += pair->second;
+                }
+                break;
+            case expect::next:
+                if (depth == 0)
+                    return false;
+
+                if ((arrays >> (depth - 1)) & 1) {
+                    if (c == ',') {
+                        state = expect::value;
+                    } else if (c == ']') {
+                        if (!v.endArray())
+                            return false;
+                        depth--;
+                    } else {
+                        return false;
+                    }
+                } else {
+                    if (c == ',') {
+                        state = expect::key;
+                    } else if (c == '}') {
+                        if (!v.endObject())
+                            return false;
+                        depth--;
+                    } else {
+                        return false;
+                    }
+                }
+                i++;
+                break;
+            }
+        }
+
+        return state == expect::next && depth == 0;
+    }
+}
+
+#endif // MINJSON_VISIT_HPP_
@@ -0,0 +1,206 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_WALKER_HPP_
+#define MINJSON_WALKER_HPP_
+
+#include "charclass.hpp"
+#include "object.hpp"
+#include "parser.hpp"
+#include "structuralindex.hpp"
+#include "type.hpp"
+
+#include <array>
+#include <optional>
+#include <string_view>
+
+namespace minjson
+{
+    /**
+     * Walks every value of a JSON document in order, without recursion.
+     * Open objects and arrays are kept on a stack of fixed capacity, so the
+     * memory used is known at compile time: about MaxDepth * 16 bytes on a
+     * 64-bit target. Exceeding the depth fails the walk rather than the
+     * program.
+     *
+     * With a structural index (better, a document), the end of each object
+     * and array is found without scanning its contents.
+     * @tparam MaxDepth Deepest nesting of objects and arrays allowed
+     */
+    template<std::size_t MaxDepth>
+    class walker
+    {
+    private:
+        constexpr static auto npos = std::string_view::npos;
+
+        // An open object or array
+        struct frame
+        {
+            std::size_t end; // Index of the closing bracket
+            bool array;
+            bool first;      // Set until a member has been read
+        };
+
+        std::array<frame, MaxDepth> m_stack;
+        std::size_t m_depth; // Number of open objects and arrays
+        std::size_t m_valueDepth; // Depth of the last value read
+        std::size_t m_index;
+        std::string_view m_json;
+        const structuralindex *m_structure;
+        bool m_started; // Set once the root value has been read
+        bool m_failed;
+
+    public:
+        constexpr walker() :
+            m_stack(), m_depth(0), m_valueDepth(0), m_index(0),
+            m_structure(nullptr), m_started(false), m_failed(true) {}
+
+        /**
+         * Starts walking the given JSON document.
+         * @param json The JSON data, which may be any JSON value
+         * @param structure Optional structural index containing json
+         * @return True if there is a value to walk
+         */
+        constexpr bool start(std::string_view json,
+                             const structuralindex *structure = nullptr)
+        {
+            if (structure && structure->offsetOf(json) == npos)
+                structure = nullptr;
+
+            m_json = json;
+            m_structure = structure;
+            m_depth = 0;
+            m_valueDepth = 0;
+            m_index = 0;
+            m_started = false;
+            m_failed = firstNonSpace(json) == npos;
+            return !m_failed;
+        }
+
+        /**
+         * Starts walking the data of the given structural index.
+         * @param structure Structural index of the JSON data
+         * @return True if there is a value to walk
+         */
+        constexpr bool start(const structuralindex& structure) {
+            return start(structure.json(), &structure);
+        }
+
+        /**
+         * Tells if the data was invalid or nested too deeply.
+         */
+        constexpr bool failed() const {
+            return m_failed;
+        }
+
+        /**
+         * Returns the depth of the last value read; zero for the root.
+         */
+        constexpr std::size_t depth() const {
+            return m_valueDepth;
+        }
+
+        /**
+         * Reads the next value in document order. An object or array is
+         * read whole; the walk then continues with its members, one level
+         * deeper, unless skip() is called.
+         * @return The value, named if it is an object member; or nothing at
+         *         the end of the document or on failure
+         */
+        constexpr std::optional<object> next() {
+            if (m_failed)
+                return {};
+
+            // Close finished objects and arrays, then pass the comma
+            auto i = firstNonSpace(m_json, m_index);
+            while (m_depth > 0 && i == m_stack[m_depth - 1].end) {
+                m_depth--;
+                i = firstNonSpace(m_json, i + 1);
+            }
+
+            if (m_depth == 0 && m_started) {
+                m_failed = i != npos;
+                return {};
+            } else if (i == npos) {
+                return fail();
+            }
+
+            std::string_view name;
+            if (m_depth > 0) {
+                auto& top = m_stack[m_depth - 1];
+                if (!top.first) {
+                    if (m_json[i] != ',')
+                        return fail();
+                    i = firstNonSpace(m_json, i + 1);
+                }
+                top.first = false;
+
+                if (!top.array) {
+                    // Read the key and colon
+                    auto key = i != npos && m_json[i] == '\"' ?
+                        parser::determineType(m_json.substr(i), m_structure) : std::nullopt;
+                    if (!key)
+                        return fail();
+                    name = m_json.substr(i + 1, key->second - 2);
+
+                    i = firstNonSpace(m_json, i + key->second);
+                    if (i == npos || m_json[i] != ':')
+                        return fail();
+                    i = firstNonSpace(m_json, i + 1);
+                }
+
+                if (i == npos || i == top.end)
+                    return fail();
+            }
+
+            auto kind = numberkind::floating;
+            auto pair = parser::determineType(m_json.substr(i), m_structure, &kind);
+            if (!pair || pair->second == 0)
+                return fail();
+
+            m_started = true;
+            m_valueDepth = m_depth;
+            m_index = i + pair->second;
+            if (pair->first == type::object || pair->first == type::array) {
+                if (m_depth == MaxDepth)
+                    return fail();
+
+                m_stack[m_depth++] = {m_index - 1, pair->first == type::array, true};
+                m_index = i + 1;
+            }
+
+            return object {name, pair->first, m_json.substr(i, pair->second), m_structure, kind};
+        }
+
+        /**
+         * Skips the members of the object or array just read.
+         */
+        constexpr void skip() {
+            if (!m_failed && m_depth > m_valueDepth) {
+                m_depth--;
+                m_index = m_stack[m_depth].end + 1;
+            }
+        }
+
+    private:
+        constexpr std::nullopt_t fail() {
+            m_failed = true;
+            return std::nullopt;
+        }
+    };
+}
+
+#endif // MINJSON_WALKER_HPP_
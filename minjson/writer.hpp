@@ -0,0 +1,290 @@
+/**
+ * Copyright (C) 2020 Clyne Sullivan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#ifndef MINJSON_WRITER_HPP_
+#define MINJSON_WRITER_HPP_
+
+#include "escape.hpp"
+#include "format.hpp"
+#include "object.hpp"
+#include "objectbase.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace minjson
+{
+    /**
+     * Writes JSON into a caller-provided buffer. Commas and colons are
+     * placed automatically; within an object, each value must follow a
+     * key().
+     *
+     * If the buffer fills up, the writer fails: nothing more is written,
+     * each call returns false, and failed() is set. The output can then be
+     * discarded, or written again into a larger buffer.
+     */
+    class writer
+    {
+    private:
+        std::span<char> m_out;
+        std::size_t m_size;
+        std::uint64_t m_members; // Bit n is set once level n has a member
+        std::uint64_t m_objects; // Bit n is set if level n is an object
+        unsigned m_depth;
+        bool m_key;              // Set after a key, until its value
+        bool m_failed;
+
+    public:
+        /**
+         * The deepest nesting of objects and arrays that can be written.
+         */
+        constexpr static unsigned maxDepth = 64;
+
+        /**
+         * @param out Where to write the JSON
+         */
+        constexpr writer(std::span<char> out) : m_out(out) {
+            reset();
+        }
+
+        /**
+         * Discards the output, to begin writing again.
+         */
+        constexpr void reset() {
+            m_size = 0;
+            m_members = 0;
+            m_objects = 0;
+            m_depth = 0;
+            m_key = false;
+            m_failed = false;
+        }
+
+        /**
+         * Tells if the buffer filled up, or objects and arrays were not
+         * properly nested.
+         */
+        constexpr bool failed() const {
+            return m_failed;
+        }
+
+        /**
+         * Returns the JSON written so far.
+         */
+        constexpr std::string_view view() const {
+            return {m_out.data(), m_size};
+        }
+
+        constexpr std::size_t size() const {
+            return m_size;
+        }
+
+        constexpr bool beginObject() {
+            return open('{');
+        }
+
+        constexpr bool endObject() {
+            return close('}');
+        }
+
+        constexpr bool beginArray() {
+            return open('[');
+        }
+
+        constexpr bool endArray() {
+            return close(']');
+        }
+
+        /**
+         * Writes the key of an object's member, escaping it as needed. Fails
+         * outside of an object, or straight after another key.
+         */
+        constexpr bool key(std::string_view name) {
+            if (!inObject() || m_key)
+                m_failed = true;
+            separate();
+            put('\"');
+            escaped(name);
+            put("\":");
+            m_key = true;
+            return !m_failed;
+        }
+
+        /**
+         * Writes a string value, escaping it as needed.
+         */
+        constexpr bool string(std::string_view str) {
+            separate();
+            put('\"');
+            escaped(str);
+            put('\"');
+            return !m_failed;
+        }
+
+        /**
+         * Writes a number. Doubles are written with the fewest digits that
+         * read back to the same value. Floating-points that are not finite
+         * cannot be written, and fail.
+         */
+        template<typename T>
+        constexpr std::enable_if_t<numeric<T>, bool> number(T n) {
+            separate();
+            if constexpr (std::is_integral_v<T>) {
+                char digits[format::maxInteger];
+                put(std::string_view(digits, format::integer(digits, n)));
+            } else if (!(n == n && n - n == 0)) {
+                // Not finite: NaN is unequal to itself, and inf - inf is NaN
+                m_failed = true;
+            } else if constexpr (std::is_same_v<T, double>) {
+                char digits[format::maxDouble];
+                put(std::string_view(digits, format::shortest(digits, n)));
+            } else {
+                char digits[64];
+                auto result = std::to_chars(digits, digits + sizeof(digits), n);
+                if (result.ec != std::errc())
+                    m_failed = true;
+                else
+                    put(std::string_view(digits, result.ptr - digits));
+            }
+            return !m_failed;
+        }
+
+        constexpr bool boolean(bool b) {
+            separate();
+            put(b ? "true" : "false");
+            return !m_failed;
+        }
+
+        constexpr bool null() {
+            separate();
+            put("null");
+            return !m_failed;
+        }
+
+        /**
+         * Writes the given JSON value as-is.
+         */
+        constexpr bool raw(std::string_view json) {
+            separate();
+            put(json);
+            return !m_failed;
+        }
+
+        /**
+         * Writes a value read by the parser exactly as it appeared.
+         */
+        constexpr bool raw(const objectbase& value) {
+            return raw(value.raw());
+        }
+
+        /**
+         * Writes a member read by the parser, its key and value, exactly as
+         * they appeared. Fails as key() does.
+         */
+        constexpr bool raw(const object& member) {
+            if (!inObject() || m_key)
+                m_failed = true;
+            separate();
+            put('\"');
+            put(member.name());
+            put("\":");
+            put(member.raw());
+            return !m_failed;
+        }
+
+    private:
+        constexpr void put(char c) {
+            if (m_failed || m_size >= m_out.size())
+                m_failed = true;
+            else
+                m_out[m_size++] = c;
+        }
+
+        constexpr void put(std::string_view str) {
+            if (m_failed || str.size() > m_out.size() - m_size) {
+                m_failed = true;
+            } else {
+                for (auto c : str)
+                    m_out[m_size++] = c;
+            }
+        }
+
+        /**
+         * Tells if the innermost open container is an object.
+         */
+        constexpr bool inObject() const {
+            return m_depth > 0 && (m_objects >> (m_depth - 1) & 1) != 0;
+        }
+
+        /**
+         * Writes a comma if the current object or array already has a
+         * member, unless a key has just been written.
+         */
+        constexpr void separate() {
+            if (m_key) {
+                m_key = false;
+            } else if (m_depth > 0) {
+                const auto bit = std::uint64_t(1) << (m_depth - 1);
+                if (m_members & bit)
+                    put(',');
+                m_members |= bit;
+            }
+        }
+
+        constexpr bool open(char c) {
+            separate();
+            if (m_depth >= maxDepth)
+                m_failed = true;
+            put(c);
+            if (!m_failed) {
+                const auto bit = std::uint64_t(1) << m_depth++;
+                m_members &= ~bit;
+                if (c == '{')
+                    m_objects |= bit;
+                else
+                    m_objects &= ~bit;
+            }
+            return !m_failed;
+        }
+
+        constexpr bool close(char c) {
+            if (m_depth == 0 || m_key || inObject() != (c == '}'))
+                m_failed = true;
+            put(c);
+            if (!m_failed)
+                m_depth--;
+            return !m_failed;
+        }
+
+        /**
+         * Writes the contents of a string, escaping quotes, backslashes and
+         * control characters.
+         */
+        constexpr void escaped(std::string_view str) {
+            if (m_failed)
+                return;
+
+            if (auto size = escape(str, m_out.subspan(m_size)); size)
+                m_size += *size;
+            else
+                m_failed = true;
+        }
+    };
+}
+
+#endif // MINJSON_WRITER_HPP_
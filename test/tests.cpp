@@ -1,7 +1,19 @@
 #define CATCH_CONFIG_MAIN
+// Catch 2's signal handling needs a constant MINSIGSTKSZ, which newer glibc lacks
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include "catch.hpp"
 
 #include "json.hpp"
+#include "mappedfile.hpp"
+#include "ndjson.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
 
 const char *goodJson = R"( { "name": "Clyne" })";
 const char *goodLongerJson = R"(
@@ -14,23 +26,23 @@ const char *goodLongerJson = R"(
 const char *missingBeginningJson = R"( "name": "Clyne" })";
 const char *missingEndJson = R"( { "name": "Clyne" )";
 
-TEST_CASE("json::parser::start")
+TEST_CASE("minjson::parser::start")
 {
-    json::parser test;
+    minjson::parser test;
     REQUIRE(test.start(goodJson)             == true);
     REQUIRE(test.start(missingBeginningJson) == false);
     REQUIRE(test.start(missingEndJson)       == false);
     REQUIRE(test.start(goodJson)             == true);
 }
 
-TEST_CASE("json::parser::isReady")
+TEST_CASE("minjson::parser::ready")
 {
-    json::parser test;
-    REQUIRE(test.isReady() == false);
+    minjson::parser test;
+    REQUIRE(test.ready() == false);
     test.start(goodJson);
-    REQUIRE(test.isReady() == true);
+    REQUIRE(test.ready() == true);
     test.start(missingBeginningJson);
-    REQUIRE(test.isReady() == false);
+    REQUIRE(test.ready() == false);
 }
 
 const char *goodStringValue   = R"( { "name": "Clyne" } )";
@@ -46,59 +58,1049 @@ const char *goodNullValue     = R"( { "dataOrNot": null } )";
 const char *badStringValue    = R"( { "name": "Clyne } )";
 const char *badValue          = R"( { "badbad": arstneio } )";
 
-TEST_CASE("json::parser::determineType")
+TEST_CASE("minjson::parser::determineType")
 {
-    json::parser test;
-
-    auto goodTest = [&](const char *s,
-                        std::size_t i,
-                        std::pair<json::type, std::size_t> p)
-    {
-        test.start(s);
-        auto result = test.determineType(i);
+    // Within the object's body, which follows the '{' at index 1, the
+    // value begins after index 'from' and ends before index 'to'
+    auto body = [](const char *s, std::size_t from) {
+        return std::string_view(s).substr(2 + from);
+    };
+    auto goodTest = [&](const char *s, std::size_t from, minjson::type t, std::size_t to) {
+        auto result = minjson::parser::determineType(body(s, from));
         REQUIRE(result);
-        REQUIRE(*result == p);
+        REQUIRE(*result == std::pair {t, to - from});
     };
-    auto badTest = [&](const char *s, std::size_t i) {
-        test.start(s);
-        auto result = test.determineType(i);
-        REQUIRE(!result);
+    auto badTest = [&](const char *s, std::size_t from) {
+        REQUIRE(!minjson::parser::determineType(body(s, from)));
     };
 
-    // First number is index before value, second number is index after value
-    goodTest(goodStringValue,   8,  {json::type::string, 16});
-    goodTest(goodStringValue2,  8,  {json::type::string, 18});
-    goodTest(goodNumberValue,   10, {json::type::number, 13});
-    goodTest(goodNumberValue2,  10, {json::type::number, 17});
-    goodTest(goodNumberValue3,  10, {json::type::number, 16});
-    goodTest(goodObjectValue,   10, {json::type::object, 27});
-    goodTest(goodArrayValue,    10, {json::type::array, 27});
-    goodTest(goodBooleanValue,  8,  {json::type::boolean, 13});
-    goodTest(goodBooleanValue2, 8,  {json::type::boolean, 14});
-    goodTest(goodNullValue,     13, {json::type::null, 18});
+    goodTest(goodStringValue,   8,  minjson::type::string, 16);
+    goodTest(goodStringValue2,  8,  minjson::type::string, 18);
+    goodTest(goodNumberValue,   10, minjson::type::number, 13);
+    goodTest(goodNumberValue2,  10, minjson::type::number, 17);
+    goodTest(goodNumberValue3,  10, minjson::type::number, 16);
+    goodTest(goodObjectValue,   10, minjson::type::object, 27);
+    goodTest(goodArrayValue,    10, minjson::type::array, 27);
+    goodTest(goodBooleanValue,  8,  minjson::type::boolean, 13);
+    goodTest(goodBooleanValue2, 8,  minjson::type::boolean, 14);
+    goodTest(goodNullValue,     13, minjson::type::null, 18);
     badTest(badStringValue, 10);
     badTest(badValue, 12);
 }
 
-TEST_CASE("json::parser::getNextObject")
+TEST_CASE("minjson::parser::next")
 {
-    json::parser test;
+    minjson::parser test;
 
-    REQUIRE(!test.getNextObject());
+    REQUIRE(!test.next());
 
     test.start(goodLongerJson);
-    auto object = test.getNextObject();
+    auto object = test.next();
     REQUIRE(object);
-    REQUIRE(object->name == "title");
-    REQUIRE(object->type == json::type::string);
-    object = test.getNextObject();
+    REQUIRE(object->name() == "title");
+    REQUIRE(object->type() == minjson::type::string);
+    object = test.next();
     REQUIRE(object);
-    REQUIRE(object->name == "salary");
-    REQUIRE(object->type == json::type::number);
-    object = test.getNextObject();
+    REQUIRE(object->name() == "salary");
+    REQUIRE(object->type() == minjson::type::number);
+    object = test.next();
     REQUIRE(object);
-    REQUIRE(object->name == "additionalInfo");
-    REQUIRE(object->type == json::type::null);
-    REQUIRE(!test.getNextObject());
+    REQUIRE(object->name() == "additionalInfo");
+    REQUIRE(object->type() == minjson::type::null);
+    REQUIRE(!test.next());
+}
+
+const char *indexedJson = R"(
+{
+    "name": "Cly\"ne {[,:]}",
+    "list": [ 1, "two" , { "three": [3] } ],
+    "child": { "flag": true }
+}
+)";
+
+TEST_CASE("minjson::structuralindex")
+{
+    std::string_view json = indexedJson;
+    std::uint64_t storage[minjson::structuralindex::storageSize(160)];
+    minjson::structuralindex index;
+    REQUIRE(index.build(json, storage));
+
+    minjson::parser plain, indexed;
+    plain.start(json);
+    indexed.start(index);
+    while (plain.ready()) {
+        auto a = plain.next();
+        auto b = indexed.next();
+        REQUIRE(a);
+        REQUIRE(b);
+        REQUIRE(a->name() == b->name());
+        REQUIRE(a->type() == b->type());
+    }
+    REQUIRE(!indexed.ready());
+
+    REQUIRE(!index.build(R"({ "name": "Cly)", storage));
+}
+
+TEST_CASE("minjson::document")
+{
+    std::string_view json = indexedJson;
+    std::uint64_t storage[minjson::structuralindex::storageSize(160)];
+    std::uint32_t table[32];
+    minjson::document doc;
+    REQUIRE(doc.build(json, storage, table));
+
+    minjson::structuralindex index;
+    std::uint64_t indexStorage[minjson::structuralindex::storageSize(160)];
+    REQUIRE(index.build(json, indexStorage));
+    for (std::size_t i = 0; i < json.size(); i++) {
+        if ((json[i] == '{' || json[i] == '[') && index.next(i) == i)
+            REQUIRE(doc.closing(i) == index.closing(i));
+    }
+
+    minjson::parser test;
+    test.start(doc);
+    test.next();
+    auto list = test.next();
+    REQUIRE(list);
+    auto entry = *list->getArrayFirst();
+    entry.next().next();
+    REQUIRE(entry.type() == minjson::type::object);
+    REQUIRE(entry.getObject()->next()->name() == "three");
+
+    REQUIRE(!doc.build(R"({ "list": [ } )", storage, table));
+    REQUIRE(!doc.build(R"({ "a": 1 ])", storage, table));
+    REQUIRE(!doc.build(R"([ 1 })", storage, table));
+    REQUIRE(!doc.build(R"({ "list": [ 1, { "a": 2 ] } })", storage, table));
+
+    // tableSize() is enough for data that is nothing but brackets
+    const std::string nested = "{ \"a\": " + std::string(500, '[') + std::string(500, ']') + " }";
+    std::vector<std::uint64_t> nestedStorage (minjson::structuralindex::storageSize(nested.size()));
+    std::vector<std::uint32_t> nestedTable (minjson::document::tableSize(nested));
+    REQUIRE(doc.build(nested, nestedStorage, nestedTable));
+    REQUIRE(doc.closing(7) == nested.size() - 3);
+}
+
+TEST_CASE("minjson::parser escaped quotes")
+{
+    minjson::parser test;
+    REQUIRE(test.start(R"({ "a": "ends in \\", "b": "quote \" and \\\" {[", "c": 1 })"));
+    REQUIRE(*test.next()->get<std::string_view>() == R"(ends in \\)");
+    REQUIRE(*test.next()->get<std::string_view>() == R"(quote \" and \\\" {[)");
+    REQUIRE(test.next()->name() == "c");
+
+    auto pair = minjson::parser::determineType(R"({ "x": "\\" })");
+    REQUIRE(pair);
+    REQUIRE(*pair == std::pair(minjson::type::object, std::size_t(13)));
+}
+
+TEST_CASE("minjson::parser::find")
+{
+    minjson::parser test;
+    test.start(goodLongerJson);
+
+    minjson::keycache<8> cache;
+    auto salary = test.find("salary", cache);
+    REQUIRE(salary);
+    REQUIRE(salary->name() == "salary");
+    REQUIRE(salary->type() == minjson::type::number);
+    REQUIRE(test.find("additionalInfo", cache)->type() == minjson::type::null);
+    REQUIRE(test.find("title", cache)->raw() == test.find("title")->raw());
+    REQUIRE(!test.find("missing", cache));
+    REQUIRE(!cache.overflow());
+
+    // Lookups do not move the parser
+    REQUIRE(test.next()->name() == "title");
+
+    minjson::keycache<2> tiny;
+    REQUIRE(test.find("additionalInfo", tiny));
+    REQUIRE(tiny.overflow());
+}
+
+TEST_CASE("minjson::get")
+{
+    minjson::parser test;
+    test.start(R"({ "menu": { "items": [ { "id": "Open" }, null,
+                    { "id": "New", "label": "Open New" } ], "a/b": { "~": 1 } } })");
+
+    auto label = minjson::get<"/menu/items/2/label">(test);
+    REQUIRE(label);
+    REQUIRE(*label->get<std::string_view>() == "Open New");
+    REQUIRE(minjson::get<"/menu/items/1">(test)->type() == minjson::type::null);
+    REQUIRE(minjson::get<"/menu/a~1b/~0">(test)->raw() == "1");
+    REQUIRE(!minjson::get<"/menu/items/3">(test));
+    REQUIRE(!minjson::get<"/menu/items/0/label">(test));
+    REQUIRE(!minjson::get<"/menu/header">(test));
+
+    // Indices too large for size_t are keys only, rather than wrapping to 1
+    REQUIRE(!minjson::get<"/menu/items/18446744073709551617">(test));
+    REQUIRE(!minjson::pointer<"/18446744073709551617">::steps[0].numeric);
+    REQUIRE(minjson::pointer<"/4294967295">::steps[0].index == 4294967295u);
+
+    auto menu = *minjson::get<"/menu">(test);
+    REQUIRE(minjson::get<"/items/0/id">(menu)->raw() == "\"Open\"");
+
+    // Members ahead of a key are skipped without determining their type
+    REQUIRE(test.start(R"({ "a": { "skip": -, "x": 2 } })"));
+    REQUIRE(*minjson::get<"/a/x">(test)->get<int>() == 2);
+}
+
+TEST_CASE("minjson::streamparser")
+{
+    std::string_view json = R"({ "name": "Cly\"ne\\", "list": [1, "]", {"a": 2}], "n": -4.5 })";
+
+    for (std::size_t size = 1; size <= json.size(); size++) {
+        char buffer[32];
+        minjson::streamparser stream (buffer);
+        std::string names;
+        for (std::size_t i = 0; i < json.size(); i += size) {
+            REQUIRE(stream.feed(json.substr(i, size), [&](const minjson::object& o) {
+                names += o.name();
+                if (o.name() == "name")
+                    REQUIRE(*o.get<std::string_view>() == R"(Cly\"ne\\)");
+                else if (o.name() == "list")
+                    REQUIRE(o.raw() == R"([1, "]", {"a": 2}])");
+                else
+                    REQUIRE(o.raw() == "-4.5");
+            }));
+        }
+        REQUIRE(stream.done());
+        REQUIRE(names == "namelistn");
+    }
+
+    char tiny[4];
+    minjson::streamparser stream (tiny);
+    REQUIRE(!stream.feed(R"({ "name)", [](const minjson::object&) {}));
+    REQUIRE(stream.failed());
+}
+
+TEST_CASE("minjson::ndjson")
+{
+    std::string data;
+    for (int i = 0; i < 5000; i++)
+        data += "{ \"id\": " + std::to_string(i) + " }\n" + (i % 100 == 0 ? "\n" : "");
+
+    minjson::ndjson lines (data);
+    int count = 0;
+    while (auto record = lines.next()) {
+        REQUIRE(record->ready());
+        count++;
+    }
+    REQUIRE(count == 5000);
+
+    std::vector<int> ids;
+    minjson::ndjson::transform(data,
+        [](minjson::parser& p) { return *p.next()->get<int>(); },
+        [&](int id) { ids.push_back(id); },
+        minjson::ndjson::order::preserved, 4);
+    REQUIRE(ids.size() == 5000);
+    REQUIRE(std::is_sorted(ids.begin(), ids.end()));
+
+    std::atomic_int visited = 0;
+    minjson::ndjson::forEach(data, [&](minjson::parser&) { visited++; }, 4);
+    REQUIRE(visited == 5000);
+}
+
+TEST_CASE("minjson::parallel::forEach")
+{
+    std::string data = "{ \"list\": [";
+    for (int i = 0; i < 2000; i++)
+        data += (i > 0 ? ", " : "") + (i % 2 ? std::to_string(i) : "[\"" + std::to_string(i) + ",]\"]");
+    data += "] }";
+
+    std::vector<std::uint64_t> storage (minjson::structuralindex::storageSize(data.size()));
+    minjson::structuralindex index;
+    REQUIRE(index.build(data, storage));
+
+    std::vector<std::size_t> starts[2];
+    for (bool indexed : {false, true}) {
+        minjson::parser test;
+        if (indexed)
+            test.start(index);
+        else
+            test.start(data);
+
+        std::atomic_int count = 0;
+        auto list = test.next();
+        REQUIRE(minjson::parallel::forEach(*list, [&](const minjson::objectbase& entry) {
+            if (entry.type() == minjson::type::number || entry.type() == minjson::type::array)
+                count++;
+        }, 4));
+        REQUIRE(count == 2000);
+        REQUIRE(!minjson::parallel::forEach(minjson::objectbase(), [](auto&) {}));
+        starts[indexed] = minjson::parallel::partition(*list);
+    }
+
+    // Both ways of partitioning split at the same commas
+    REQUIRE(starts[0].size() == 2000 / minjson::parallel::grainSize + 1);
+    REQUIRE(starts[0] == starts[1]);
+}
+
+TEST_CASE("minjson::objectbase::get numbers")
+{
+    auto number = [](std::string_view text) {
+        return minjson::objectbase(minjson::type::number, text);
+    };
+
+    REQUIRE(*number("-12.5e3").get<double>() == -12500.0);
+    REQUIRE(*number("0.1").get<double>() == 0.1);
+    REQUIRE(*number("0.1").get<float>() == 0.1f);
+    REQUIRE(*number("1e23").get<double>() == 1e23);
+    REQUIRE(*number("9007199254740993").get<double>() == 9007199254740992.0);
+    REQUIRE(*number("2.2250738585072011e-308").get<double>() == 2.2250738585072011e-308);
+    REQUIRE(*number("4.9406564584124654e-324").get<double>() == 4.9406564584124654e-324);
+    REQUIRE(*number("123456789012345678901234567890").get<double>() == 1.2345678901234568e29);
+    REQUIRE(*number("1e400").get<double>() == std::numeric_limits<double>::infinity());
+    REQUIRE(*number("-1e-400").get<double>() == 0.0);
+
+    REQUIRE(*number("-15").get<int>() == -15);
+    REQUIRE(*number("42.9").get<int>() == 42);
+    REQUIRE(*number("1.5e3").get<int>() == 1500);
+    REQUIRE(!number("-").get<double>());
+}
+
+TEST_CASE("minjson::parser::scanNumber")
+{
+    using minjson::numberkind;
+    auto scan = [](std::string_view s) { return minjson::parser::scanNumber(s); };
+
+    REQUIRE(*scan("0") == std::pair(numberkind::int64, std::size_t(1)));
+    REQUIRE(*scan("-12, ") == std::pair(numberkind::int64, std::size_t(3)));
+    REQUIRE(*scan("1e-7}") == std::pair(numberkind::floating, std::size_t(4)));
+    REQUIRE(*scan("6.02E+23") == std::pair(numberkind::floating, std::size_t(8)));
+    REQUIRE(*scan("9223372036854775807") == std::pair(numberkind::int64, std::size_t(19)));
+    REQUIRE(*scan("-9223372036854775808") == std::pair(numberkind::int64, std::size_t(20)));
+    REQUIRE(*scan("9223372036854775808") == std::pair(numberkind::uint64, std::size_t(19)));
+    REQUIRE(*scan("-9223372036854775809") == std::pair(numberkind::floating, std::size_t(20)));
+    REQUIRE(*scan("18446744073709551616") == std::pair(numberkind::floating, std::size_t(20)));
+
+    for (auto bad : {"-", "01", "1.", ".5", "1e", "1e+", "--1", "+1"})
+        REQUIRE(!scan(bad));
+
+    minjson::parser test;
+    test.start(R"({ "a": 1e-7, "b": 6.02E23, "c": -9223372036854775808, "d": 18446744073709551615 })");
+    REQUIRE(*test.next()->get<double>() == 1e-7);
+    REQUIRE(*test.next()->get<double>() == 6.02e23);
+
+    auto c = test.next();
+    REQUIRE(c->numberkind() == numberkind::int64);
+    REQUIRE(*c->get<std::int64_t>() == std::numeric_limits<std::int64_t>::min());
+    REQUIRE(!c->get<std::uint64_t>());
+    REQUIRE(!c->get<int>());
+
+    auto d = test.next();
+    REQUIRE(d->numberkind() == numberkind::uint64);
+    REQUIRE(*d->get<std::uint64_t>() == std::numeric_limits<std::uint64_t>::max());
+    REQUIRE(!d->get<std::int64_t>());
+    REQUIRE(!test.ready());
+}
+
+TEST_CASE("minjson::objectbase::getUnescaped")
+{
+    auto string = [](std::string_view text) {
+        return minjson::objectbase(minjson::type::string, text);
+    };
+
+    char buffer[64];
+    auto plain = string(R"("no escapes here")");
+    REQUIRE(plain.getUnescaped(buffer)->data() == plain.raw().data() + 1);
+
+    REQUIRE(*string(R"("a\"b\\c\/d\n\t")").getUnescaped(buffer) == "a\"b\\c/d\n\t");
+    REQUIRE(*string(R"("caf\u00e9 \u20ac")").getUnescaped(buffer) == "caf\xc3\xa9 \xe2\x82\xac");
+    REQUIRE(*string(R"("\ud83d\ude00!")").getUnescaped(buffer) == "\xf0\x9f\x98\x80!");
+
+    std::string longer (100, 'x');
+    longer += "\\n";
+    longer += std::string(100, 'y');
+    REQUIRE(!string('"' + longer + '"').getUnescaped(buffer));
+    char large[256];
+    auto unescaped = *string('"' + longer + '"').getUnescaped(large);
+    REQUIRE(unescaped == std::string(100, 'x') + '\n' + std::string(100, 'y'));
+
+    for (auto bad : {R"("\x")", R"("\u12")", R"("\ud83d")", R"("\ude00")", R"("\ud83dA")"})
+        REQUIRE(!string(bad).getUnescaped(buffer));
+    REQUIRE(!string(R"("a\nb")").getUnescaped(std::span(buffer, 2)));
+    REQUIRE(!minjson::objectbase(minjson::type::number, "1").getUnescaped(buffer));
+
+    char storage[16];
+    minjson::arena a (storage);
+    REQUIRE(*string(R"("x\ty")").getUnescaped(a) == "x\ty");
+    REQUIRE(a.used() == 3);
+    REQUIRE(*string(R"("plain")").getUnescaped(a) == "plain");
+    REQUIRE(a.used() == 3);
+    REQUIRE(!string(R"("\u00e9\u00e9\u00e9")").getUnescaped(a));
+    a.reset();
+    REQUIRE(*string(R"("\u00e9\u00e9")").getUnescaped(a) == "\xc3\xa9\xc3\xa9");
+    REQUIRE(a.used() == 4);
+}
+
+TEST_CASE("minjson::validation::utf8")
+{
+    using minjson::validation;
+    std::string good = "{ \"name\": \"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\", \"pad\": \"";
+    good += std::string(100, 'x') + "\" }";
+    std::string bad = good;
+    bad[80] = '\xff';
+    std::string overlong = "{ \"a\": \"\xc0\xaf\" }";
+    std::string surrogate = "{ \"a\": \"\xed\xa0\x80\" }";
+    std::string truncated = "{ \"a\": \"\xe2\x82\" }";
+
+    minjson::parser test;
+    REQUIRE(test.start(good, validation::utf8));
+    REQUIRE(test.start(bad));
+    for (const auto& json : {bad, overlong, surrogate, truncated})
+        REQUIRE(!test.start(json, validation::utf8));
+
+    std::vector<std::uint64_t> storage (minjson::structuralindex::storageSize(good.size()));
+    minjson::structuralindex index;
+    REQUIRE(index.build(good, storage, validation::utf8));
+    REQUIRE(index.utf8());
+    REQUIRE(test.start(index.json(), &index, validation::utf8));
+    REQUIRE(!index.build(bad, storage, validation::utf8));
+    REQUIRE(index.build(bad, storage));
+    REQUIRE(!index.utf8());
+
+    // Characters split across chunks
+    char buffer[256];
+    minjson::streamparser stream (buffer, validation::utf8);
+    int members = 0;
+    for (std::size_t i = 0; i < good.size(); i += 7)
+        REQUIRE(stream.feed(std::string_view(good).substr(i, 7), [&](auto&) { members++; }));
+    REQUIRE(stream.done());
+    REQUIRE(members == 2);
+
+    stream.reset();
+    REQUIRE(!stream.feed(bad, [](auto&) {}));
+
+    const auto records = good + '\n' + bad + '\n' + good;
+    minjson::ndjson lines (records, validation::utf8);
+    REQUIRE(lines.next()->ready());
+    REQUIRE(!lines.next()->ready());
+    REQUIRE(lines.next()->ready());
+
+    std::atomic_int count = 0;
+    minjson::ndjson::forEach(good + '\n' + bad, [&](auto&) { count++; }, 1, validation::utf8);
+    REQUIRE(count == 1);
+}
+
+TEST_CASE("minjson::charclass")
+{
+    using minjson::charclass;
+
+    REQUIRE(minjson::classOf('\t') == charclass::space);
+    REQUIRE(minjson::classOf('7') == charclass::digit);
+    REQUIRE(minjson::classOf('n') == charclass::literal);
+    REQUIRE(minjson::classOf('\xff') == charclass::other);
+    REQUIRE(minjson::firstNonSpace(" \r\n\t x ") == 5);
+    REQUIRE(minjson::firstNonSpace("ab", 2) == std::string_view::npos);
+    REQUIRE(minjson::lastNonSpace(" x \n") == 1);
+    REQUIRE(minjson::lastNonSpace(" \t ") == std::string_view::npos);
+
+    auto pair = minjson::parser::determineType(" \n nulls");
+    REQUIRE(*pair == std::pair(minjson::type::null, std::size_t(7)));
+    REQUIRE(!minjson::parser::determineType(" +1"));
+    REQUIRE(!minjson::parser::determineType("nil"));
+}
+
+TEST_CASE("minjson::paddedview")
+{
+    const std::string json = "{ \"n\": -12.5e2, \"s\": \"x\\\"y\", \"a\": [1, [2], {\"b\": 3}], \"z\": 7}";
+    std::vector<char> storage (minjson::paddedview::storageSize(json.size()));
+    REQUIRE(!minjson::paddedview::copy(json, std::span(storage).first(json.size())));
+    auto view = minjson::paddedview::copy(json, storage);
+    REQUIRE(view);
+    REQUIRE(view->view() == json);
+    REQUIRE(minjson::paddedview::adopt(storage, json.size()));
+    REQUIRE(!minjson::paddedview::adopt(storage, json.size() + 1));
+    storage.back() = ' ';
+    REQUIRE(!minjson::paddedview::adopt(storage, json.size()));
+    storage.back() = '\0';
+
+    minjson::parser padded, plain;
+    REQUIRE(padded.start(*view));
+    REQUIRE(plain.start(json));
+    for (int i = 0; i < 4; i++) {
+        auto a = padded.next(), b = plain.next();
+        REQUIRE(a);
+        REQUIRE(a->name() == b->name());
+        REQUIRE(a->raw() == b->raw());
+        REQUIRE(a->numberkind() == b->numberkind());
+    }
+    REQUIRE(!padded.next());
+
+    auto array = padded.find("a")->getArrayFirst();
+    REQUIRE(*array->get<int>() == 1);
+    REQUIRE(array->next().raw() == "[2]");
+    REQUIRE(*array->next().getObject()->find("b")->get<int>() == 3);
+    REQUIRE(!array->next().valid());
+    REQUIRE(*padded.find("n")->get<double>() == -1250.0);
+    REQUIRE(*padded.find("z")->get<int>() == 7);
+
+    // Entries visited in parallel keep reading within the padding
+    std::atomic_int paddedEntries = 0;
+    REQUIRE(minjson::parallel::forEach(*padded.find("a"), [&](const minjson::objectbase& entry) {
+        paddedEntries += entry.padded();
+    }, 2));
+    REQUIRE(paddedEntries == 3);
+
+    // Values that are cut short within the padded storage are still found
+    // within bounds
+    REQUIRE(*minjson::parser::determineType<true>(view->view().substr(7, 3))
+            == std::pair(minjson::type::number, std::size_t(3)));
+    REQUIRE(!minjson::parser::determineType<true>(view->view().substr(21, 4)));
+}
+
+TEST_CASE("minjson::staticindex")
+{
+    using config = minjson::staticindex<R"({
+        "uart": { "baud": 115200, "parity": null, "echo": true },
+        "gain": -2.5e-1,
+        "pins": [ 4, [5], {} ],
+        "a/b": "x",
+        "empty": []
+    })">;
+
+    static_assert(config::size == 13);
+    static_assert(config::at<"/uart/baud">().integer == 115200);
+    static_assert(config::at<"/gain">().number == -0.25);
+    static_assert(config::at<"/uart/echo">().boolean);
+    static_assert(config::at<"/pins/1/0">().number == 5);
+    static_assert(config::at<"">().type() == minjson::type::object);
+
+    REQUIRE(config::entries[1].path == "/uart");
+    REQUIRE(config::find("/uart/parity")->type() == minjson::type::null);
+    REQUIRE(config::find("/pins/2")->type() == minjson::type::object);
+    REQUIRE(config::find("/empty")->value.raw() == "[]");
+    REQUIRE(*config::find("/a~1b")->value.get<std::string_view>() == "x");
+    REQUIRE(config::find("/a/b") == nullptr);
+    REQUIRE(config::find("/pins/3") == nullptr);
+    REQUIRE(config::indexOf("/gain") == 5);
+}
+
+namespace
+{
+    struct point
+    {
+        int x = 0;
+        int y = 0;
+    };
+
+    struct settings
+    {
+        std::string_view name;
+        double gain = 0;
+        bool enabled = false;
+        std::optional<unsigned> limit;
+        point origin;
+    };
+
+    using pointfields = minjson::fields<
+        minjson::field<"x", &point::x>,
+        minjson::field<"y", &point::y>>;
+
+    using settingsfields = minjson::fields<
+        minjson::field<"name", &settings::name>,
+        minjson::field<"gain", &settings::gain>,
+        minjson::field<"enabled", &settings::enabled>,
+        minjson::field<"limit", &settings::limit>,
+        minjson::field<"origin", &settings::origin, pointfields>>;
+}
+
+TEST_CASE("minjson::fields")
+{
+    minjson::parser p;
+    settings s;
+    REQUIRE(p.start(R"({ "gain": 1.5, "skip": [1, {"x": 9}], "name": "amp",
+                         "origin": {"y": -2, "x": 3}, "enabled": true, "limit": 10 })"));
+    REQUIRE(settingsfields::decode(p, s));
+    REQUIRE(s.name == "amp");
+    REQUIRE(s.gain == 1.5);
+    REQUIRE(s.enabled);
+    REQUIRE(s.limit == 10u);
+    REQUIRE(s.origin.x == 3);
+    REQUIRE(s.origin.y == -2);
+
+    REQUIRE(p.start(R"({ "limit": null, "nam": "x" })"));
+    REQUIRE(settingsfields::decode(p, s));
+    REQUIRE(!s.limit);
+    REQUIRE(s.name == "amp");
+
+    REQUIRE(p.start(R"({ "gain": "loud" })"));
+    REQUIRE(!settingsfields::decode(p, s));
+    REQUIRE(p.start(R"({ "limit": -1 })"));
+    REQUIRE(!settingsfields::decode(p, s));
+
+    // Malformed objects fail, with the fields read before the error written
+    point half;
+    REQUIRE(p.start(R"({ "x": 1, "y": })"));
+    REQUIRE(!pointfields::decode(p, half));
+    REQUIRE(half.x == 1);
+    REQUIRE(half.y == 0);
+    REQUIRE(p.start(R"({ })"));
+    REQUIRE(pointfields::decode(p, half));
+
+    constexpr auto decoded = [] {
+        minjson::parser q;
+        q.start(R"({"y": 5, "x": 4})");
+        point pt;
+        pointfields::decode(q, pt);
+        return pt;
+    }();
+    static_assert(decoded.x == 4 && decoded.y == 5);
+}
+
+namespace
+{
+    // Records each callback of visit() as text
+    struct recorder
+    {
+        std::string events;
+
+        void on_begin_object() { events += '{'; }
+        void on_end_object() { events += '}'; }
+        void on_begin_array() { events += '['; }
+        void on_end_array() { events += ']'; }
+        void on_key(std::string_view key) { events += std::string(key) + ':'; }
+        void on_string(std::string_view str) { events += '\'' + std::string(str) + "' "; }
+        void on_number(const minjson::objectbase& n) { events += std::to_string(*n.get<int>()) + ' '; }
+        void on_boolean(bool b) { events += b ? "T " : "F "; }
+        void on_null() { events += "N "; }
+    };
+
+    // Sums numbers until it finds a negative one
+    struct summer
+    {
+        int sum = 0;
+
+        constexpr bool on_number(const minjson::objectbase& n) {
+            sum += *n.get<int>();
+            return sum >= 0;
+        }
+    };
+}
+
+TEST_CASE("minjson::visit")
+{
+    recorder r;
+    REQUIRE(minjson::visit(R"( {"a": [1, "x\"y", true, null, {}], "b": {"c": false}, "d": []} )", r));
+    REQUIRE(r.events == R"({a:[1 'x\"y' T N {}]b:{c:F }d:[]})");
+
+    r.events.clear();
+    REQUIRE(minjson::visit("[[[2]]]", r));
+    REQUIRE(r.events == "[[[2 ]]]");
+
+    for (auto bad : {"", "{", "[1,]", "{\"a\" 1}", "{\"a\":1,}", "[1 2]", "{1:2}", "[1]]", "[truex]", "[01]"}) {
+        r.events.clear();
+        REQUIRE(!minjson::visit(bad, r));
+    }
+
+    std::string deep (65, '[');
+    deep += std::string(65, ']');
+    REQUIRE(!minjson::visit(deep, r));
+    REQUIRE(minjson::visit(deep.substr(1, 128), r));
+
+    // Callbacks may stop the walk, and handlers need define only some
+    summer s;
+    REQUIRE(!minjson::visit("[1, 2, -5, 10]", s));
+    REQUIRE(s.sum == -2);
+
+    static_assert([] {
+        summer cs;
+        return minjson::visit(R"({"x": [1, {"y": 2}], "z": 3})", cs) && cs.sum == 6;
+    }());
 }
 
+TEST_CASE("minjson::walker")
+{
+    constexpr std::string_view json = R"({"a": [1, {"b": null}], "c": {"d": "x"}, "e": []})";
+
+    // Records each value as its depth, name and type
+    auto walk = [](minjson::walker<4>& w) {
+        std::string out;
+        while (auto o = w.next()) {
+            out += std::to_string(w.depth()) + std::string(o->name()) + ' ';
+            if (o->type() == minjson::type::object && o->name() == "c")
+                w.skip();
+        }
+        return out;
+    };
+
+    minjson::walker<4> w;
+    REQUIRE(w.start(json));
+    REQUIRE(walk(w) == "0 1a 2 2 3b 1c 1e ");
+    REQUIRE(!w.failed());
+
+    std::uint64_t storage[8];
+    std::uint32_t table[16];
+    minjson::document doc;
+    REQUIRE(doc.build(json, storage, table));
+    REQUIRE(w.start(doc));
+    REQUIRE(walk(w) == "0 1a 2 2 3b 1c 1e ");
+
+    // Values keep their extent, and the root may be any value
+    REQUIRE(w.start("[\"s\", 2.5e1, [true]]"));
+    REQUIRE(w.next()->raw() == "[\"s\", 2.5e1, [true]]");
+    REQUIRE(*w.next()->get<std::string_view>() == "s");
+    REQUIRE(*w.next()->get<double>() == 25);
+    REQUIRE(w.next()->raw() == "[true]");
+    REQUIRE(*w.next()->get<bool>());
+    REQUIRE(!w.next());
+    REQUIRE(!w.failed());
+
+    // Too deep, or invalid, fails cleanly
+    REQUIRE(w.start("[[[[[1]]]]]"));
+    while (w.next());
+    REQUIRE(w.failed());
+    REQUIRE(w.start("[[[[1]]]]"));
+    while (w.next());
+    REQUIRE(!w.failed());
+
+    for (auto bad : {"", "[1,]", "[1 2]", "{\"a\" 1}", "{\"a\":1,}", "[1] 2", "{1:2}"}) {
+        w.start(bad);
+        while (w.next());
+        REQUIRE(w.failed());
+    }
+
+    static_assert([] {
+        minjson::walker<2> cw;
+        cw.start(R"({"x": [1, 2], "y": 3})");
+        int sum = 0;
+        while (auto o = cw.next())
+            sum += o->get<int>().value_or(0);
+        return sum == 6 && !cw.failed();
+    }());
+}
+
+TEST_CASE("minjson::cursor")
+{
+    static constexpr std::string_view json =
+        R"({"id": 7, "skip": {"a": [1, "]}", {"b": "\"x,"}]}, "list": [1, 2], "name": "n", "last": true})";
+
+    auto check = [](minjson::cursor c) {
+        REQUIRE(c.ready());
+        REQUIRE(*c.find("id")->get<int>() == 7);
+        REQUIRE(c.find("name")->raw() == "\"n\"");
+        REQUIRE(!c.find("list")); // Behind the cursor
+        REQUIRE(*c.find("last")->get<bool>());
+        c.rewind();
+        REQUIRE(c.find("list")->raw() == "[1, 2]");
+        REQUIRE(!c.find("missing"));
+        REQUIRE(c.find("name"));
+
+        // The name refers to the data, not to the key searched for
+        c.rewind();
+        auto id = c.find(std::string("id"));
+        REQUIRE(id->name() == "id");
+        REQUIRE(id->name().data() == json.data() + 2);
+    };
+
+    minjson::parser p;
+    REQUIRE(p.start(json));
+    check(minjson::cursor(p));
+
+    std::uint64_t storage[8];
+    minjson::structuralindex index;
+    REQUIRE(index.build(json, storage));
+    REQUIRE(p.start(index));
+    check(minjson::cursor(p));
+
+    std::uint32_t table[32];
+    minjson::document doc;
+    REQUIRE(doc.build(json, storage, table));
+    REQUIRE(p.start(doc));
+    check(minjson::cursor(p));
+
+    // Nested objects through getObject()
+    minjson::cursor nested (*minjson::cursor(p).find("skip")->getObject());
+    REQUIRE(nested.find("a")->type() == minjson::type::array);
+
+    REQUIRE(!minjson::cursor().find("id"));
+    REQUIRE(p.start(R"({"a": [1, 2})"));
+    REQUIRE(!minjson::cursor(p).find("b"));
+
+    static_assert([] {
+        minjson::parser cp;
+        cp.start(R"({"x": {"y": [1, 2]}, "z": 3})");
+        minjson::cursor cc (cp);
+        return *cc.find("z")->get<int>() == 3;
+    }());
+}
+
+TEST_CASE("minjson::arrayobject random access")
+{
+    std::string json = R"({"list": [)";
+    for (int i = 0; i < 100; i++)
+        json += (i > 0 ? ", " : "") + (i % 3 == 0 ? std::to_string(i) : i % 3 == 1 ?
+            "\"" + std::to_string(i) + ",]\"" : "[" + std::to_string(i) + ", {\"x\": []}]");
+    json += "], \"empty\": [ ]}";
+
+    // Each entry holds its index, as a number, a string, or an array's first
+    auto check = [](const minjson::arrayobject& entry, int i) {
+        REQUIRE(entry.valid());
+        REQUIRE(entry.position() == static_cast<std::size_t>(i));
+        if (entry.type() == minjson::type::number)
+            REQUIRE(*entry.get<int>() == i);
+        else if (entry.type() == minjson::type::string)
+            REQUIRE(*entry.get<std::string_view>() == std::to_string(i) + ",]");
+        else
+            REQUIRE(*entry.getArrayFirst()->get<int>() == i);
+    };
+
+    auto test = [&](const minjson::parser& p) {
+        auto list = *p.find("list")->getArrayFirst();
+        REQUIRE(list.size() == 100);
+        check(list.at(0), 0);
+        check(list.at(57), 57);
+        check(list.at(99), 99);
+        REQUIRE(!list.at(100).valid());
+
+        auto page = list.at(40);
+        for (int i = 40; i < 50; i++, page.next())
+            check(page, i);
+        check(page.skip(5), 55);
+        check(page.skip(1), 56);
+        REQUIRE(!page.skip(50).valid());
+
+        std::uint32_t storage[8];
+        minjson::arrayindex index (storage, 16);
+        for (int i : {70, 3, 99, 16, 17, 98, 0})
+            check(list.at(i, index), i);
+        REQUIRE(index.count() == 7);
+        REQUIRE(list.size(index) == 100);
+        REQUIRE(!list.at(100, index).valid());
+
+        auto empty = *p.find("empty")->getArrayFirst();
+        REQUIRE(empty.size() == 0);
+        REQUIRE(empty.size(index) == 0);
+        REQUIRE(!empty.at(0, index).valid());
+    };
+
+    minjson::parser p;
+    REQUIRE(p.start(json));
+    test(p);
+
+    std::vector<std::uint64_t> storage (minjson::structuralindex::storageSize(json.size()));
+    std::vector<std::uint32_t> table (minjson::document::tableSize(json));
+    minjson::document doc;
+    REQUIRE(doc.build(json, storage, table));
+    REQUIRE(p.start(doc));
+    test(p);
+
+    static_assert([] {
+        minjson::parser cp;
+        cp.start(R"({"a": [1, [2, 3], "4", 5]})");
+        auto a = *cp.find("a")->getArrayFirst();
+        return a.size() == 4 && *a.at(3).get<int>() == 5 && a.skip(2).position() == 2;
+    }());
+}
+
+TEST_CASE("minjson::arrayobject::count")
+{
+    auto count = [](std::string_view array) {
+        minjson::objectbase o (minjson::type::array, array);
+        return o.getArrayFirst()->count();
+    };
+
+    REQUIRE(count("[]") == 0);
+    REQUIRE(count("[ ]") == 0);
+    REQUIRE(count("[1]") == 1);
+    REQUIRE(count(R"([1, "a,b", [2, 3], {"c": [4, 5], "d": "]"}, "\",\\"])") == 5);
+    REQUIRE(count(R"([[[]], [[1, 2]], {}])") == 3);
+
+    // Across blocks, with commas and brackets in long strings
+    std::string array = "[";
+    for (int i = 0; i < 300; i++) {
+        array += i > 0 ? "," : "";
+        array += i % 4 == 0 ? "{\"k\": [1, 2, 3]}" : i % 4 == 1 ? std::to_string(i) :
+                 i % 4 == 2 ? "\"" + std::string(i % 70, ',') + "]\\\\\"" : "[[], \"[\"]";
+        REQUIRE(count(array + "]") == static_cast<std::size_t>(i + 1));
+    }
+
+    // The array ends at its own closing bracket
+    minjson::parser p;
+    REQUIRE(p.start(R"({"a": [1, 2, [3, 4]], "b": [5, 6]})"));
+    REQUIRE(p.find("a")->getArrayFirst()->count() == 3);
+    REQUIRE(p.find("a")->getArrayFirst()->size() == 3);
+
+    static_assert(minjson::objectbase(minjson::type::array,
+        R"([{"a": [1, 2]}, 3, "4,5"])").getArrayFirst()->count() == 3);
+}
+
+TEST_CASE("minjson::escape")
+{
+    char out[256];
+    auto escaped = [&](std::string_view str) {
+        auto size = minjson::escape(str, out);
+        return size ? std::string(out, *size) : std::string("(failed)");
+    };
+
+    REQUIRE(escaped("") == "");
+    REQUIRE(escaped("plain text") == "plain text");
+    REQUIRE(escaped("a\"b\\c/d") == R"(a\"b\\c/d)");
+    REQUIRE(escaped("\b\f\n\r\t") == R"(\b\f\n\r\t)");
+    REQUIRE(escaped(std::string_view("\0\x1f\x7f", 3)) == "\\u0000\\u001f\x7f");
+    REQUIRE(escaped("caf\xc3\xa9") == "caf\xc3\xa9");
+
+    // Characters to escape at every position of the blocks
+    std::string text (100, 'x');
+    for (std::size_t i = 0; i < text.size(); i++) {
+        text[i] = '\n';
+        auto expected = std::string(i, 'x') + "\\n" + std::string(99 - i, 'x');
+        REQUIRE(escaped(text) == expected);
+        text[i] = 'x';
+    }
+
+    REQUIRE(!minjson::escape(text, std::span(out, 99)));
+    REQUIRE(!minjson::escape("ab\n", std::span(out, 3)));
+    REQUIRE(*minjson::escape("ab\n", std::span(out, 4)) == 4);
+
+    static_assert([] {
+        char buffer[16] {};
+        return *minjson::escape("a\tb\x01", buffer) == 10 && buffer[9] == '1';
+    }());
+}
+
+TEST_CASE("minjson::writer")
+{
+    char buffer[256];
+    minjson::writer w (buffer);
+    w.beginObject();
+    w.key("name");
+    w.string("a\"b\n\x01");
+    w.key("list");
+    w.beginArray();
+    w.number(-12);
+    w.number(0.5);
+    w.boolean(true);
+    w.null();
+    w.beginObject();
+    w.endObject();
+    w.endArray();
+    w.key("max");
+    w.number(std::numeric_limits<std::uint64_t>::max());
+    REQUIRE(w.endObject());
+    REQUIRE(!w.failed());
+    REQUIRE(w.view() == R"({"name":"a\"b\n\u0001","list":[-12,0.5,true,null,{}],"max":18446744073709551615})");
+
+    // Values read by the parser pass through unchanged
+    minjson::parser p;
+    REQUIRE(p.start(w.view()));
+    char copy[256];
+    minjson::writer c (copy);
+    c.beginObject();
+    while (auto o = p.next())
+        c.raw(*o);
+    c.endObject();
+    REQUIRE(c.view() == w.view());
+
+    // Overflow fails without writing past the buffer
+    minjson::writer small (std::span(buffer, 8));
+    small.beginArray();
+    small.string("0123456789");
+    REQUIRE(small.failed());
+    REQUIRE(!small.number(1));
+    REQUIRE(small.size() == 2);
+
+    minjson::writer bad (buffer);
+    REQUIRE(!bad.endArray());
+    bad.reset();
+    bad.beginArray();
+    REQUIRE(!bad.key("a")); // Would be ["a":
+    bad.reset();
+    REQUIRE(!bad.key("a"));
+    bad.reset();
+    bad.beginObject();
+    REQUIRE(bad.key("a"));
+    REQUIRE(!bad.key("b"));
+    bad.reset();
+    bad.beginObject();
+    REQUIRE(!bad.endArray());
+    bad.reset();
+    REQUIRE(!bad.number(std::numeric_limits<double>::infinity()));
+    bad.reset();
+    REQUIRE(!bad.number(std::numeric_limits<float>::quiet_NaN()));
+
+    constexpr auto length = [] {
+        char out[32] {};
+        minjson::writer cw (out);
+        cw.beginArray();
+        cw.number(42u);
+        cw.string("x");
+        cw.number(0.25);
+        cw.endArray();
+        return cw.size();
+    }();
+    static_assert(length == 13);
+}
+
+TEST_CASE("minjson::format")
+{
+    char out[32];
+    auto text = [&](std::size_t size) { return std::string_view(out, size); };
+
+    REQUIRE(text(minjson::format::integer(out, 0)) == "0");
+    REQUIRE(text(minjson::format::integer(out, 100000000)) == "100000000");
+    REQUIRE(text(minjson::format::integer(out, std::numeric_limits<std::int64_t>::min()))
+            == "-9223372036854775808");
+    REQUIRE(text(minjson::format::integer(out, std::numeric_limits<std::uint64_t>::max()))
+            == "18446744073709551615");
+
+    REQUIRE(text(minjson::format::shortest(out, 0.1)) == "0.1");
+    REQUIRE(text(minjson::format::shortest(out, -0.0)) == "-0");
+    REQUIRE(text(minjson::format::shortest(out, 1e22)) == "1e+22");
+    REQUIRE(text(minjson::format::shortest(out, 1152921504606846976.0)) == "1152921504606846976"); // 2^60
+    REQUIRE(text(minjson::format::shortest(out, 295147905179352825856.0)) == "295147905179352825856"); // 2^68
+    REQUIRE(text(minjson::format::shortest(out, 0.001)) == "0.001");
+    REQUIRE(text(minjson::format::shortest(out, 1.5e-7)) == "1.5e-07");
+    REQUIRE(text(minjson::format::shortest(out, 123456.75)) == "123456.75");
+    REQUIRE(text(minjson::format::shortest(out, 5e-324)) == "5e-324");
+    REQUIRE(text(minjson::format::shortest(out, 1.7976931348623157e308))
+            == "1.7976931348623157e+308");
+
+    // Written numbers read back exactly
+    for (double d : {0.3, 2.0 / 3.0, 6.02214076e23, 2.2250738585072014e-308, 9007199254740993.0}) {
+        auto size = minjson::format::shortest(out, d);
+        REQUIRE(*minjson::objectbase(minjson::type::number, text(size)).get<double>() == d);
+    }
+
+    static_assert([] {
+        char digits[20] {};
+        return minjson::format::integer(digits, -1200340) == 8 && digits[7] == '0';
+    }());
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_CASE("minjson::mappedfile")
+{
+    char path[] = "/tmp/minjson-test-XXXXXX";
+    const int fd = mkstemp(path);
+    REQUIRE(fd >= 0);
+
+    // Empty files are not mapped
+    minjson::mappedfile file;
+    REQUIRE(!file.open(path));
+    REQUIRE(!file.valid());
+
+    constexpr std::string_view json = R"({ "name": "mapped", "list": [1, 2, 3] })";
+    REQUIRE(write(fd, json.data(), json.size()) == static_cast<ssize_t>(json.size()));
+    close(fd);
+
+    REQUIRE(file.open(path));
+    REQUIRE(file.valid());
+    REQUIRE(file.view() == json);
+
+    minjson::parser p;
+    REQUIRE(p.start(file.view()));
+    REQUIRE(*p.find("name")->get<std::string_view>() == "mapped");
+    REQUIRE(*p.find("list")->getArrayFirst()->at(2).get<int>() == 3);
+
+    // Moving hands over the mapping
+    minjson::mappedfile moved(std::move(file));
+    REQUIRE(!file.valid());
+    REQUIRE(moved.view() == json);
+
+    unlink(path);
+    REQUIRE(!minjson::mappedfile(path).valid());
+    REQUIRE(!moved.open(path));
+    REQUIRE(!moved.valid());
+}
+#endif